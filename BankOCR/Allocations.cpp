@@ -0,0 +1,65 @@
+#include "Allocations.h"
+
+#ifdef BANKOCR_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+namespace {
+	// plain integers: a thread_local with a constructor could allocate itself
+	thread_local uint64_t allocations, bytes, frees;
+
+	void* allocate(size_t size) {
+		++allocations;
+		bytes += size;
+		if (auto p = std::malloc(size ? size : 1)) return p;
+		throw std::bad_alloc();
+	}
+
+	void release(void* p) {
+		if (!p) return;
+		++frees;
+		std::free(p);
+	}
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	try { return allocate(size); }
+	catch (const std::bad_alloc&) { return nullptr; }
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	try { return allocate(size); }
+	catch (const std::bad_alloc&) { return nullptr; }
+}
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+
+bool isCountingAllocations()
+{
+	return true;
+}
+
+AllocationCount getAllocations()
+{
+	AllocationCount ret;
+	ret.allocations = allocations;
+	ret.bytes = bytes;
+	ret.frees = frees;
+	return ret;
+}
+#else
+bool isCountingAllocations()
+{
+	return false;
+}
+
+AllocationCount getAllocations()
+{
+	return AllocationCount();
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+// heap use of the calling thread; counted only where Allocations.cpp is compiled with
+// BANKOCR_COUNT_ALLOCATIONS (the Tests and Bench projects do, the library does not), which
+// replaces the global operator new and delete with counting hooks, so tests can hold the
+// hot paths to an allocation budget and the bench report them, while ocrtool keeps the
+// default allocator
+struct AllocationCount
+{
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+	uint64_t frees = 0;
+
+	AllocationCount operator-(const AllocationCount& start) const {
+		AllocationCount ret;
+		ret.allocations = allocations - start.allocations;
+		ret.bytes = bytes - start.bytes;
+		ret.frees = frees - start.frees;
+		return ret;
+	}
+};
+
+// false if the operators are not replaced and the counts stay 0
+bool isCountingAllocations();
+// running totals of the thread
+AllocationCount getAllocations();
+
+// allocations of f() on this thread
+template <class F>
+AllocationCount countAllocations(F f) {
+	auto start = getAllocations();
+	f();
+	return getAllocations() - start;
+}
@@ -0,0 +1,147 @@
+#include "Archive.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	const char magic[8] = { 'B', 'K', 'O', 'C', 'R', 'I', 'D', 'X' };
+	const size_t headerSize = 32;
+	const size_t entrySize = 4 * OCR::width;
+
+	bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+	void putVarint(std::vector<unsigned char>& out, uint64_t v) {
+		for (; v >= 0x80; v >>= 7) out.push_back((unsigned char)(v | 0x80));
+		out.push_back((unsigned char)v);
+	}
+
+	uint64_t getVarint(const unsigned char*& in, const unsigned char* end) {
+		uint64_t v = 0;
+		for (int shift = 0; in < end && shift < 64; shift += 7) {
+			auto b = *in++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (!(b & 0x80)) return v;
+		}
+		throw std::runtime_error("corrupt entry index");
+	}
+}
+
+size_t frameEntry(const char* data, size_t size, size_t pos, char* entry)
+{
+	std::fill(entry, entry + entrySize, ' ');
+	for (int line = 0; line < 4 && pos < size; ++line) {
+		auto newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+		auto end = newline ? size_t(newline - data) : size;
+		auto length = end - pos;
+		if (length && data[end - 1] == '\r') --length;
+		if (line < 3) std::memcpy(entry + line * OCR::width, data + pos, std::min<size_t>(length, OCR::width));
+		pos = newline ? end + 1 : size;
+	}
+	return pos;
+}
+
+size_t getContentSize(const char* data, size_t size)
+{
+	while (size && isBlank(data[size - 1])) --size;
+	return size;
+}
+
+EntryIndex::EntryIndex(const std::string& path)
+	: file(path)
+{
+	auto data = file.data();
+	if (file.size() < headerSize || std::memcmp(data, magic, 8) != 0) throw std::runtime_error("not an entry index: " + path);
+	uint64_t entries;
+	std::memcpy(&entries, data + 8, 8);
+	std::memcpy(&archiveSize, data + 16, 8);
+	std::memcpy(&interval, data + 24, 4);
+	// every entry takes a byte at least, so the counts below cannot overflow
+	if (!interval || entries > file.size()) throw std::runtime_error("truncated entry index: " + path);
+	auto checkpointCount = (entries + interval - 1) / interval;
+	if (checkpointCount > (file.size() - headerSize) / 16) throw std::runtime_error("truncated entry index: " + path);
+
+	count = size_t(entries);
+	checkpoints = reinterpret_cast<const uint64_t*>(data + headerSize);
+	deltas = reinterpret_cast<const unsigned char*>(data + headerSize + 16 * checkpointCount);
+	end = reinterpret_cast<const unsigned char*>(data + file.size());
+}
+
+uint64_t EntryIndex::getOffset(size_t entry) const
+{
+	if (entry >= count) throw std::out_of_range("entry " + std::to_string(entry) + " of " + std::to_string(count));
+	auto checkpoint = checkpoints + 2 * (entry / interval);
+	auto offset = checkpoint[0];
+	if (checkpoint[1] > uint64_t(end - deltas)) throw std::runtime_error("corrupt entry index");
+	auto in = deltas + checkpoint[1];
+	for (auto n = entry % interval; n; --n) offset += getVarint(in, end);
+	return offset;
+}
+
+void writeEntryIndex(const std::string& archive, const std::string& index, uint32_t interval)
+{
+	if (!interval) throw std::invalid_argument("checkpoint interval has to be positive");
+	MappedFile file(archive);
+	auto data = file.data();
+	auto size = getContentSize(data, file.size());
+
+	std::vector<uint64_t> checkpoints;
+	std::vector<unsigned char> deltas;
+	char entry[entrySize];
+	uint64_t entries = 0;
+	for (size_t pos = 0, last = 0; pos < size; ++entries) {
+		if (entries % interval == 0) {
+			checkpoints.push_back(pos);
+			checkpoints.push_back(deltas.size());
+		}
+		else putVarint(deltas, pos - last);
+		last = pos;
+		pos = frameEntry(data, file.size(), pos, entry);
+	}
+
+	char header[headerSize] = {};
+	std::memcpy(header, magic, 8);
+	uint64_t archiveSize = file.size();
+	std::memcpy(header + 8, &entries, 8);
+	std::memcpy(header + 16, &archiveSize, 8);
+	std::memcpy(header + 24, &interval, 4);
+
+	std::ofstream out(index, std::ios::binary);
+	out.write(header, headerSize);
+	out.write(reinterpret_cast<const char*>(checkpoints.data()), std::streamsize(checkpoints.size() * 8));
+	out.write(reinterpret_cast<const char*>(deltas.data()), std::streamsize(deltas.size()));
+	if (!out) throw std::runtime_error("cannot write " + index);
+}
+
+ScanArchive::ScanArchive(const std::string& archive, const std::string& indexPath)
+	: file(archive), index(indexPath)
+{
+	if (index.getArchiveSize() != file.size()) throw std::runtime_error(indexPath + " is no index of " + archive);
+}
+
+std::string ScanArchive::getEntry(size_t entry) const
+{
+	std::string ret(entrySize, ' ');
+	frameEntry(file.data(), file.size(), size_t(index.getOffset(entry)), &ret[0]);
+	return ret;
+}
+
+std::vector<int> ScanArchive::read(size_t entry, const GlyphSet& glyphs) const
+{
+	return OCR::read(getEntry(entry), glyphs);
+}
+
+std::vector<std::vector<int>> ScanArchive::read(size_t first, size_t count, const GlyphSet& glyphs) const
+{
+	if (first > size() || count > size() - first) throw std::out_of_range("entries past the end of the archive");
+	std::vector<std::vector<int>> ret;
+	if (!count) return ret;
+	// entries are consecutive, so the range is framed from the first offset on
+	std::string entry(entrySize, ' ');
+	auto pos = size_t(index.getOffset(first));
+	for (size_t n = 0; n < count; ++n) {
+		pos = frameEntry(file.data(), file.size(), pos, &entry[0]);
+		ret.push_back(OCR::read(entry, glyphs));
+	}
+	return ret;
+}
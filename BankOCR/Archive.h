@@ -0,0 +1,66 @@
+#pragma once
+#include "MappedFile.h"
+#include "OCR.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// tolerant framing of a scan archive: an entry is three lines of art and a fourth line
+// that is ignored; lines may end in "\r\n", be cut short (trailing blanks trimmed) or run
+// longer than OCR::width, and the last line may miss its newline
+//
+// copies the entry starting at pos into entry (4 * OCR::width bytes, as OCR::read takes it)
+// and returns the position of the next entry
+size_t frameEntry(const char* data, size_t size, size_t pos, char* entry);
+// size without trailing blank lines, entries start before it
+size_t getContentSize(const char* data, size_t size);
+
+// sidecar index of the entry offsets, built in one pass over the archive
+//
+// little endian: a 32 byte header "BKOCRIDX", uint64 entries, uint64 archive size,
+// uint32 interval, uint32 0; then per 'interval' entries a checkpoint of uint64 offset
+// and uint64 position in the deltas; then the offset deltas of all other entries as
+// LEB128 varints, one byte for the usual 112 or 114 byte entries
+class EntryIndex
+{
+public:
+	explicit EntryIndex(const std::string& path);
+
+	size_t size() const { return count; }
+	uint64_t getArchiveSize() const { return archiveSize; }
+	// one seek to the checkpoint, at most interval - 1 deltas decoded
+	uint64_t getOffset(size_t entry) const;
+
+private:
+	MappedFile file;
+	size_t count = 0;
+	uint64_t archiveSize = 0;
+	uint32_t interval = 1;
+	const uint64_t* checkpoints = nullptr;
+	const unsigned char* deltas = nullptr;
+	const unsigned char* end = nullptr;
+};
+
+// frames the archive and writes its index, checkpoints every interval entries
+void writeEntryIndex(const std::string& archive, const std::string& index, uint32_t interval = 64);
+
+// a mapped archive with its index, decodes entries on demand; throws std::runtime_error
+// if the index does not belong to the archive
+class ScanArchive
+{
+public:
+	ScanArchive(const std::string& archive, const std::string& index);
+
+	size_t size() const { return index.size(); }
+	uint64_t getOffset(size_t entry) const { return index.getOffset(entry); }
+	// the framed entry, 4 * OCR::width bytes
+	std::string getEntry(size_t entry) const;
+
+	std::vector<int> read(size_t entry, const GlyphSet& glyphs = OCR::getGlyphSet()) const;
+	// count entries from first on, one index lookup for the whole range
+	std::vector<std::vector<int>> read(size_t first, size_t count, const GlyphSet& glyphs = OCR::getGlyphSet()) const;
+
+private:
+	MappedFile file;
+	EntryIndex index;
+};
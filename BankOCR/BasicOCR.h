@@ -0,0 +1,192 @@
+#pragma once
+#include "Checksum.h"
+#include "GlyphSet.h"
+#include <cassert>
+#include <string>
+#include <vector>
+
+// glyph set policy: 3x3 ascii art per digit and the digits one stroke away from it;
+// the kata's table is not symmetric (6 has no replacements, though 5 and 8 are a stroke
+// away), and getGlyphSet carries it as it is
+struct KataFont
+{
+	static const int count = 10;
+	static const char* const glyphs[count];
+	static const std::vector<int> replacements[count];
+};
+
+// decoder and checksum for accounts of 'Digits' glyphs, all loops run over compile time bounds
+template <class Font, int Digits, class Checksum = WeightedMod11<Digits>>
+class BasicOCR
+{
+public:
+	static const int digits = Digits;
+	static const int width = 3 * Digits;
+
+	// multiline string => vector of digits
+	static std::vector<int> read(const std::string& input) {
+		return read(input, getGlyphSet());
+	}
+
+	// decodes with a loaded font instead of Font, noisy bytes mapped by classes
+	static std::vector<int> read(const std::string& input, const GlyphSet& glyphs, const ByteClasses& classes = ByteClasses::getExact()) {
+		assert(4 * width == input.size());
+		std::vector<int> result(Digits);
+		read(input.data(), result.data(), glyphs, classes);
+		return result;
+	}
+
+	// 4 * width bytes => Digits digits in out, without allocating
+	static void read(const char* input, int* out, const GlyphSet& glyphs = getGlyphSet(), const ByteClasses& classes = ByteClasses::getExact()) {
+		for (int i = 0; i < Digits; ++i) out[i] = glyphs.decode(input + 3 * i, width, classes);
+	}
+
+	// Digits digits => 4 * width bytes in Font's glyphs, the inverse of read
+	static std::string render(const std::vector<int>& digits) {
+		assert(digits.size() == Digits);
+		std::string ret(4 * width, ' ');
+		for (int i = 0; i < Digits; ++i) {
+			for (int p = 0; p < 9; ++p) ret[p / 3 * width + 3 * i + p % 3] = Font::glyphs[digits[i]][p];
+		}
+		return ret;
+	}
+
+	// rows of any multiple of width => the accounts side by side in the band
+	static std::vector<std::vector<int>> readBand(const std::string& input,
+		const GlyphSet& glyphs = getGlyphSet(), const ByteClasses& classes = ByteClasses::getExact()) {
+		const int rowWidth = int(input.size() / 4);
+		assert(4 * rowWidth == int(input.size()) && rowWidth % width == 0);
+		std::vector<int> cells(rowWidth / 3);
+		glyphs.decodeRows(input.data(), rowWidth, cells.data(), classes);
+		std::vector<std::vector<int>> result;
+		for (auto it = cells.begin(); it != cells.end(); it += Digits) result.emplace_back(it, it + Digits);
+		return result;
+	}
+
+	static std::string getPos(const std::string& input, int i) {
+		return
+			input.substr(i * 3, 3)
+			+ input.substr(width + i * 3, 3)
+			+ input.substr(2 * width + i * 3, 3);
+	}
+
+	static int getNumber(const std::string& str) {
+		if (str.size() != 9) return -1;
+		return getGlyphSet().decode(str.data(), 3);
+	}
+
+	// Font compiled into a stroke mask table, with Font::replacements as its neighbours
+	static const GlyphSet& getGlyphSet() {
+		static const GlyphSet glyphs = [] {
+			GlyphSet ret(getGlyphs());
+			for (int d = 0; d < Font::count; ++d) ret.setReplacements(d, Font::replacements[d]);
+			return ret;
+		}();
+		return glyphs;
+	}
+
+	// digit => 7 bit stroke mask (top, upper left, middle, upper right, lower left, bottom, lower right)
+	static int getStrokes(int digit) {
+		static const int strokePos[7] = { 1, 3, 4, 5, 6, 7, 8 };
+		auto mask = 0;
+		for (int s = 0; s < 7; ++s) {
+			if (Font::glyphs[digit][strokePos[s]] != ' ') mask |= 1 << s;
+		}
+		return mask;
+	}
+
+	// unreduced checksum, in has to be legible
+	static int getSum(const std::vector<int>& in) {
+		assert(Digits == in.size());
+		auto ret = 0;
+		for (int p = 0; p < Digits; ++p) ret += Checksum::weight(p, in[p]);
+		return ret;
+	}
+
+	// distance of the checksum to the target, 0 for valid accounts
+	static int getCheckSum(const std::vector<int>& in) {
+		return getResidue(getSum(in));
+	}
+
+	// checksum residue with in[pos] replaced by digit
+	static int getReplacedSum(int sum, const std::vector<int>& in, int pos, int digit) {
+		return getResidue(sum - Checksum::weight(pos, in[pos]) + Checksum::weight(pos, digit));
+	}
+
+	static std::string getDigits(const std::vector<int>& in) {
+		std::string ret(in.size(), '?');
+		for (size_t p = 0; p < in.size(); ++p) {
+			if (in[p] >= 0) ret[p] = char('0' + in[p]);
+		}
+		return ret;
+	}
+
+	static std::string getCheck(const std::vector<int>& in) {
+		std::string ret = getDigits(in);
+		for (auto n : in) {
+			if (n < 0) return ret + " ILL";
+		}
+		return ret + (getCheckSum(in) ? " ERR" : "");
+	}
+
+	// valid accounts one stroke away, stops at the second one
+	static std::vector<std::vector<int>> checkReplace(std::vector<int> in) {
+		std::vector<std::vector<int>> results;
+		results.reserve(2);
+		const auto sum = getSum(in);
+		for (int pos = 0; pos < Digits; ++pos) {
+			int org = in[pos];
+			for (auto r : getGlyphSet().getReplacements(org)) {
+				if (getReplacedSum(sum, in, pos, r) == 0) {
+					in[pos] = r;
+					results.push_back(in);
+					in[pos] = org;
+					if (results.size() > 1) {
+						return results;
+					}
+				}
+			}
+		}
+		return results;
+	}
+
+	static std::string getCheckPlus(const std::vector<int>& in) {
+		std::string ret = getDigits(in);
+		for (auto n : in) {
+			if (n < 0) return ret + " ILL";
+		}
+		const auto sum = getSum(in);
+		if (0 == getResidue(sum)) return ret;
+
+		// the repairs of checkReplace, counted instead of collected
+		auto fixPos = -1, fixDigit = -1;
+		for (int pos = 0; pos < Digits; ++pos) {
+			for (auto r : getGlyphSet().getReplacements(in[pos])) {
+				if (getReplacedSum(sum, in, pos, r) != 0) continue;
+				if (fixPos >= 0) return ret + " AMB";
+				fixPos = pos;
+				fixDigit = r;
+			}
+		}
+		if (fixPos < 0) return ret + " ERR";
+		ret[fixPos] = char('0' + fixDigit);
+		return ret + " FIX";
+	}
+
+private:
+	static std::vector<std::pair<int, std::string>> getGlyphs() {
+		std::vector<std::pair<int, std::string>> ret;
+		for (int d = 0; d < Font::count; ++d) ret.emplace_back(d, Font::glyphs[d]);
+		return ret;
+	}
+
+	static int getResidue(int sum) {
+		auto r = (sum - Checksum::target) % Checksum::modulus;
+		return r < 0 ? r + Checksum::modulus : r;
+	}
+};
+
+template <class Font, int Digits, class Checksum>
+const int BasicOCR<Font, Digits, Checksum>::digits;
+template <class Font, int Digits, class Checksum>
+const int BasicOCR<Font, Digits, Checksum>::width;
@@ -0,0 +1,415 @@
+#include "Batch.h"
+#include "Archive.h"
+#include "Confusion.h"
+#include "Format.h"
+#include "Hash.h"
+#include "KnownAccounts.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// entries decoded and formatted per output write
+	const size_t chunk = 4096;
+	// bytes hashed at either end of the input for its identity
+	const size_t identityBytes = 64 << 10;
+
+	const char magic[8] = { 'B', 'K', 'O', 'C', 'R', 'J', 'N', 'L' };
+
+	// the committed state, check hashes the fields before it so torn writes are detected
+	struct Journal
+	{
+		char magic[8];
+		uint64_t inputSize;
+		uint64_t inputHash;
+		uint64_t inputOffset;
+		uint64_t entries;
+		uint64_t outputLength;
+		// getRepairTag of the options the output was decoded with
+		uint64_t repairTag;
+		uint64_t check;
+
+		uint64_t getCheck() const { return getHash(this, offsetof(Journal, check)); }
+	};
+
+	// a file kept open for positional reads and writes, truncation and data syncs
+#ifdef _WIN32
+	class SyncFile
+	{
+	public:
+		explicit SyncFile(const std::string& path) : path(path) {
+			file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot open " + path);
+		}
+		~SyncFile() { CloseHandle(file); }
+
+		bool read(void* data, size_t size, uint64_t offset) const {
+			OVERLAPPED at = {};
+			at.Offset = DWORD(offset);
+			at.OffsetHigh = DWORD(offset >> 32);
+			DWORD n = 0;
+			return ReadFile(file, data, DWORD(size), &n, &at) && n == size;
+		}
+		void write(const void* data, size_t size, uint64_t offset) const {
+			OVERLAPPED at = {};
+			at.Offset = DWORD(offset);
+			at.OffsetHigh = DWORD(offset >> 32);
+			DWORD n = 0;
+			if (!WriteFile(file, data, DWORD(size), &n, &at) || n != size) throw std::runtime_error("cannot write " + path);
+		}
+		void truncate(uint64_t size) const {
+			LARGE_INTEGER end;
+			end.QuadPart = LONGLONG(size);
+			if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) throw std::runtime_error("cannot truncate " + path);
+		}
+		void sync() const {
+			if (!FlushFileBuffers(file)) throw std::runtime_error("cannot sync " + path);
+		}
+
+	private:
+		std::string path;
+		HANDLE file;
+	};
+#else
+	class SyncFile
+	{
+	public:
+		explicit SyncFile(const std::string& path) : path(path) {
+			fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+			if (fd < 0) throw std::runtime_error("cannot open " + path);
+		}
+		~SyncFile() { ::close(fd); }
+
+		bool read(void* data, size_t size, uint64_t offset) const {
+			return pread(fd, data, size, off_t(offset)) == ssize_t(size);
+		}
+		void write(const void* data, size_t size, uint64_t offset) const {
+			auto p = static_cast<const char*>(data);
+			while (size) {
+				auto n = pwrite(fd, p, size, off_t(offset));
+				if (n <= 0) throw std::runtime_error("cannot write " + path);
+				p += n;
+				size -= size_t(n);
+				offset += uint64_t(n);
+			}
+		}
+		void truncate(uint64_t size) const {
+			if (ftruncate(fd, off_t(size)) != 0) throw std::runtime_error("cannot truncate " + path);
+		}
+		void sync() const {
+#ifdef __APPLE__
+			auto ok = fsync(fd) == 0;
+#else
+			auto ok = fdatasync(fd) == 0;
+#endif
+			if (!ok) throw std::runtime_error("cannot sync " + path);
+		}
+
+	private:
+		std::string path;
+		int fd;
+	};
+#endif
+
+	const char cacheMagic[8] = { 'B', 'K', 'O', 'C', 'R', 'C', 'C', 'H' };
+
+	struct CacheHeader
+	{
+		char magic[8];
+		uint64_t tag;
+		uint64_t inputSize;
+		uint64_t inputHash;
+		uint64_t blocks;
+		uint64_t entries;
+	};
+
+	// a chunk of entries: its bytes in the input and the index of its first result
+	struct CacheBlock
+	{
+		uint64_t offset;
+		uint64_t length;
+		uint64_t hash;
+		uint64_t first;
+		uint64_t entries;
+	};
+
+	// results of the last finished run on an input, the header followed by the blocks
+	// and the results of all entries
+	class ResultCache
+	{
+	public:
+		ResultCache(const std::string& path, uint64_t tag) {
+			if (!std::ifstream(path)) return;
+			file = MappedFile(path);
+			if (file.size() < sizeof(CacheHeader)) return;
+			auto h = reinterpret_cast<const CacheHeader*>(file.data());
+			auto size = sizeof(CacheHeader) + h->blocks * sizeof(CacheBlock) + h->entries * sizeof(Result);
+			if (std::memcmp(h->magic, cacheMagic, 8) != 0 || h->tag != tag || file.size() != size) return;
+			header = h;
+			blocks = reinterpret_cast<const CacheBlock*>(header + 1);
+			results = reinterpret_cast<const Result*>(blocks + header->blocks);
+			for (uint64_t b = 0; b < header->blocks; ++b) {
+				if (blocks[b].first + blocks[b].entries <= header->entries) byOffset[blocks[b].offset] = size_t(b);
+			}
+		}
+
+		// all results if the input is the one cached
+		const Result* getAll(const char* data, size_t size, size_t& count) const {
+			if (!header || header->inputSize != size || header->inputHash != getHash(data, size)) return nullptr;
+			count = size_t(header->entries);
+			return results;
+		}
+
+		// results of the same block in the cached input
+		const Result* find(uint64_t offset, uint64_t length, uint64_t hash, size_t entries) const {
+			auto it = byOffset.find(offset);
+			if (it == byOffset.end()) return nullptr;
+			auto& b = blocks[it->second];
+			return b.length == length && b.hash == hash && b.entries == entries ? results + b.first : nullptr;
+		}
+
+		void add(uint64_t offset, uint64_t length, uint64_t hash, const Result* block, size_t entries) {
+			added.push_back({ offset, length, hash, addedResults.size(), entries });
+			addedResults.insert(addedResults.end(), block, block + entries);
+		}
+
+		// replaces the cache by the blocks added
+		void write(const std::string& path, uint64_t tag, const char* data, size_t size) {
+			file = MappedFile();
+			header = nullptr;
+			CacheHeader h = {};
+			std::memcpy(h.magic, cacheMagic, 8);
+			h.tag = tag;
+			h.inputSize = size;
+			h.inputHash = getHash(data, size);
+			h.blocks = added.size();
+			h.entries = addedResults.size();
+			std::ofstream out(path, std::ios::binary);
+			out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+			out.write(reinterpret_cast<const char*>(added.data()), std::streamsize(added.size() * sizeof(CacheBlock)));
+			out.write(reinterpret_cast<const char*>(addedResults.data()), std::streamsize(addedResults.size() * sizeof(Result)));
+			if (!out) throw std::runtime_error("cannot write " + path);
+		}
+
+	private:
+		MappedFile file;
+		const CacheHeader* header = nullptr;
+		const CacheBlock* blocks = nullptr;
+		const Result* results = nullptr;
+		std::unordered_map<uint64_t, size_t> byOffset;
+		std::vector<CacheBlock> added;
+		std::vector<Result> addedResults;
+	};
+
+	// what the results depend on besides the input: the checksum weights and residues, the
+	// glyph set's digits and neighbours, the repair costs and the known accounts
+	uint64_t getRepairTag(const RepairOptions& repair, uint64_t tag) {
+		std::vector<int64_t> v;
+		const auto& scheme = repair.checksum ? *repair.checksum : ChecksumScheme::getMod11();
+		v.push_back(scheme.getLength());
+		for (int p = 0; p < scheme.getLength(); ++p) {
+			for (int d = 0; d < 10; ++d) v.push_back(scheme.getDelta(p, 0, d));
+		}
+		for (int s = 0; s < 256; ++s) v.push_back(scheme.getResidue(s));
+		v.push_back(repair.glyphs != nullptr);
+		if (repair.glyphs) {
+			for (int mask = 0; mask < 128; ++mask) v.push_back(repair.glyphs->getDigit(mask));
+			for (int d = 0; d < 10; ++d) {
+				v.push_back(-1);
+				for (auto r : repair.glyphs->getReplacements(d)) v.push_back(r);
+			}
+		}
+		v.push_back(repair.model != nullptr);
+		if (repair.model) {
+			for (int a = 0; a < 10; ++a) {
+				for (int b = 0; b < 10; ++b) v.push_back(repair.model->getRepairCost(a, b));
+			}
+			v.push_back(repair.model->getMargin());
+		}
+		v.push_back(repair.known != nullptr);
+		if (repair.known) v.push_back(int64_t(repair.known->getContentHash()));
+		return getHash(v.data(), v.size() * sizeof(int64_t), tag);
+	}
+
+	uint64_t getIdentity(const char* data, size_t size) {
+		auto head = std::min(size, identityBytes);
+		auto tail = std::min(size - head, identityBytes);
+		return getHash(data + size - tail, tail, getHash(data, head));
+	}
+}
+
+BatchStats runBatch(const std::string& input, const std::string& output, const BatchOptions& options)
+{
+	MappedFile in(input);
+	const auto data = in.data();
+	const auto size = getContentSize(data, in.size());
+
+	Journal state = {};
+	std::memcpy(state.magic, magic, 8);
+	state.inputSize = in.size();
+	state.inputHash = getIdentity(data, in.size());
+	state.repairTag = getRepairTag(options.repair, options.cacheTag);
+
+	BatchStats stats;
+	SyncFile out(output);
+	std::unique_ptr<SyncFile> journal;
+	if (!options.journal.empty()) {
+		journal.reset(new SyncFile(options.journal));
+		Journal last;
+		if (journal->read(&last, sizeof(last), 0) && std::memcmp(last.magic, magic, 8) == 0 && last.check == last.getCheck()
+			&& last.inputSize == state.inputSize && last.inputHash == state.inputHash && last.repairTag == state.repairTag
+			&& last.inputOffset <= size) {
+			state = last;
+			stats.resumed = last.entries;
+		}
+	}
+	// drops what an interrupted run wrote behind its last checkpoint
+	out.truncate(state.outputLength);
+
+	auto* counters = options.metrics ? &options.metrics->getCounters(0) : nullptr;
+	auto* trace = options.trace;
+	auto commit = [&] {
+		TraceSpan span(trace, "checkpoint", "batch");
+		out.sync();
+		state.check = state.getCheck();
+		journal->write(&state, sizeof(state), 0);
+		journal->sync();
+		++stats.checkpoints;
+		if (counters) WorkerCounters::add(counters->checkpoints, 1);
+	};
+
+	std::unique_ptr<ResultCache> cache;
+	if (!options.cache.empty()) {
+		TraceSpan span(trace, "load cache", "batch");
+		cache.reset(new ResultCache(options.cache, state.repairTag));
+	}
+
+	std::vector<Result> results(chunk);
+	std::vector<char> text(getFormatSize(chunk));
+	auto* latency = options.latency ? options.latency : options.metrics ? &options.metrics->getLatency(0) : nullptr;
+	const size_t sample = size_t(std::max(1, options.latencySample));
+	auto put = [&](const Result* block, size_t n) {
+		TraceSpan span(trace, "output", "batch", int64_t(n));
+		auto start = latency ? getTicks() : 0;
+		auto length = formatResults(block, n, text.data());
+		out.write(text.data(), length, state.outputLength);
+		state.entries += n;
+		state.outputLength += length;
+		if (latency) (*latency)[Stage::output].record(getTicks() - start);
+		if (counters) {
+			WorkerCounters::add(counters->entries, n);
+			for (size_t i = 0; i < n; ++i) WorkerCounters::add(counters->status[int(block[i].status)], 1);
+		}
+	};
+
+	// a resent file: the cached results as they are, without framing
+	size_t cachedCount = 0;
+	auto cached = cache && state.inputOffset == 0 && !options.limit ? cache->getAll(data, in.size(), cachedCount) : nullptr;
+	if (cached) {
+		for (size_t first = 0; first < cachedCount; first += chunk) put(cached + first, std::min(chunk, cachedCount - first));
+		for (size_t i = 0; i < cachedCount; ++i) stats.errors.add(cached[i]);
+		if (counters) {
+			WorkerCounters::add(counters->cacheHits, cachedCount);
+			WorkerCounters::add(counters->bytes, size);
+		}
+		stats.reused = cachedCount;
+		state.inputOffset = size;
+	}
+
+	std::vector<std::string> entries(chunk, std::string(4 * OCR::width, ' '));
+	std::vector<int> digits(OCR::digits);
+	auto pos = size_t(state.inputOffset);
+	auto lastCheckpoint = pos;
+	auto limited = false;
+	while (pos < size) {
+		auto start = pos;
+		size_t n = 0;
+		TraceSpan chunkSpan(trace, "chunk", "batch");
+		auto frameStart = trace ? getTicks() : 0;
+		for (; n < chunk && pos < size; ++n) {
+			if (options.limit && stats.entries + stats.reused + n == options.limit) {
+				limited = true;
+				break;
+			}
+			auto timed = latency && n % sample == 0;
+			auto start = timed ? getTicks() : 0;
+			pos = frameEntry(data, in.size(), pos, &entries[n][0]);
+			if (timed) (*latency)[Stage::frame].record(getTicks() - start);
+		}
+		if (trace) {
+			trace->span("frame", "batch", frameStart, getTicks(), int64_t(n));
+			chunkSpan.setValue(int64_t(n));
+		}
+		// hashed while the framed bytes are still in the cache
+		auto hash = cache ? getHash(data + start, pos - start) : 0;
+		auto block = cache ? cache->find(start, pos - start, hash, n) : nullptr;
+		if (block) {
+			TraceSpan span(trace, "cache hit", "batch", int64_t(n));
+			std::copy(block, block + n, results.begin());
+			for (size_t i = 0; i < n; ++i) stats.errors.add(results[i]);
+			stats.reused += n;
+		}
+		else {
+			TraceSpan span(trace, "decode", "batch", int64_t(n));
+			for (size_t i = 0; i < n; ++i) {
+				auto timed = latency && i % sample == 0;
+				auto start = timed ? getTicks() : 0;
+				OCR::read(entries[i].data(), digits.data());
+				auto read = timed ? getTicks() : 0;
+				auto validated = validate(digits, options.repair);
+				auto valid = timed ? getTicks() : 0;
+				results[i] = getResult(digits, options.repair, validated);
+				if (timed) {
+					(*latency)[Stage::read].record(read - start);
+					(*latency)[Stage::validate].record(valid - read);
+					if (validated == Status::err) (*latency)[Stage::repair].record(getTicks() - valid);
+				}
+				stats.errors.add(entries[i], digits, results[i]);
+			}
+			stats.entries += n;
+		}
+		if (cache) cache->add(start, pos - start, hash, results.data(), n);
+		if (counters) {
+			WorkerCounters::add(block ? counters->cacheHits : counters->decoded, n);
+			WorkerCounters::add(counters->bytes, pos - start);
+		}
+		put(results.data(), n);
+		state.inputOffset = pos;
+		if (limited) break;
+		if (journal && pos - lastCheckpoint >= options.checkpointBytes) {
+			commit();
+			lastCheckpoint = pos;
+		}
+	}
+
+	if (journal && limited) commit();
+	else {
+		out.sync();
+		// a resumed run lacks the results before the checkpoint, a limited one those behind the limit
+		if (cache && !cached && !stats.resumed && !limited) {
+			TraceSpan span(trace, "write cache", "batch");
+			cache->write(options.cache, state.repairTag, data, in.size());
+		}
+		if (journal) {
+			journal.reset();
+			std::remove(options.journal.c_str());
+		}
+	}
+	return stats;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "ErrorStats.h"
+#include "Latency.h"
+#include "Metrics.h"
+#include "OCR.h"
+#include "Trace.h"
+#include <cstdint>
+#include <string>
+
+struct BatchOptions
+{
+	RepairOptions repair;
+	// file of the last committed position, no checkpoints if empty
+	std::string journal;
+	// input bytes between checkpoints, each syncs the output and then the journal;
+	// checked after every 4096 entries
+	uint64_t checkpointBytes = 64 << 20;
+	// entries to process in this run, 0 for all; a run stopped by the limit keeps its journal
+	uint64_t limit = 0;
+	// results of the last finished run, no caching if empty: an unchanged input reuses
+	// all of them, otherwise every chunk of 4096 entries with the same offset and XXH64
+	// of its bytes reuses its own, so appended entries are the only ones decoded;
+	// resumed runs and runs stopped by the limit leave the cache as it is
+	std::string cache;
+	// mixed into the tag of the cached results and the journal, which is derived from the repair options
+	// (scheme, glyph set, model and the known accounts' content); results cached under
+	// another tag are not reused, so a change of the code behind them may bump it
+	uint64_t cacheTag = 0;
+	// records the stages of decoded entries, and the output per chunk, no timing if null;
+	// may be read by other threads while the batch runs
+	StageLatency* latency = nullptr;
+	// times one entry in latencySample, time stamps cost tens of ns on some virtual machines
+	int latencySample = 8;
+	// counters of worker 0 updated per chunk, and its histograms used if latency is null
+	Metrics* metrics = nullptr;
+	// spans of every chunk and its stages (frame, decode or cache hit, output, checkpoint)
+	// on the calling thread's track, no tracing if null
+	Tracer* trace = nullptr;
+};
+
+struct BatchStats
+{
+	// decoded in this run
+	uint64_t entries = 0;
+	// committed by an earlier run and skipped
+	uint64_t resumed = 0;
+	// taken from the cache
+	uint64_t reused = 0;
+	uint64_t checkpoints = 0;
+	// of the entries of this run, cached ones without masks and fixes
+	ErrorStats errors;
+};
+
+// decodes every entry of the archive input (framed by frameEntry) and writes its
+// getCheckPlus line to output
+//
+// with a journal, a run that finds the journal of an earlier run on the same input
+// (same size and hashes of its first and last 64 KB) and with the same repair options
+// (the tag of the cache) truncates the output to the committed length and resumes
+// behind the committed entry, otherwise it starts over; the journal is removed
+// once the input is done; throws std::runtime_error on I/O errors
+BatchStats runBatch(const std::string& input, const std::string& output, const BatchOptions& options = BatchOptions());
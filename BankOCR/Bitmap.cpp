@@ -0,0 +1,209 @@
+#include "Bitmap.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	// 16384 x 16384, far beyond any scan of account numbers
+	const uint64_t maxPixels = uint64_t(1) << 28;
+
+	void skipSpace(std::istream& in) {
+		for (;;) {
+			auto c = in.peek();
+			if (c == '#') {
+				std::string comment;
+				std::getline(in, comment);
+			}
+			else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') in.get();
+			else return;
+		}
+	}
+
+	int readNumber(std::istream& in) {
+		skipSpace(in);
+		int v = -1;
+		if (!(in >> v) || v < 0) throw std::runtime_error("malformed bitmap header");
+		return v;
+	}
+
+	// strongest ink share of the rows (horizontal) or columns of a region
+	double getCoverage(const Bitmap& image, int x0, int x1, int y0, int y1, bool horizontal, int threshold) {
+		if (x1 <= x0 || y1 <= y0) return 0;
+		auto best = 0;
+		int outer0 = horizontal ? y0 : x0, outer1 = horizontal ? y1 : x1;
+		int inner0 = horizontal ? x0 : y0, inner1 = horizontal ? x1 : y1;
+		for (int o = outer0; o < outer1; ++o) {
+			auto ink = 0;
+			for (int i = inner0; i < inner1; ++i) {
+				ink += (horizontal ? image.at(i, o) : image.at(o, i)) < threshold;
+			}
+			if (ink > best) best = ink;
+		}
+		return double(best) / (inner1 - inner0);
+	}
+
+	// stroke masks of the cells of width w starting at x0
+	std::vector<int> getCellMasks(const Bitmap& image, std::pair<int, int> band, double x0, double w, const RasterOptions& options) {
+		// sampled regions per stroke as fractions of the cell: x from/to in thirds, y from/to in eighths
+		struct Region { int x0, x1, y0, y1; bool horizontal; };
+		static const Region regions[7] = {
+			{ 1, 2, 0, 2, true },	// top
+			{ 0, 1, 1, 3, false },	// upper left
+			{ 1, 2, 3, 5, true },	// middle
+			{ 2, 3, 1, 3, false },	// upper right
+			{ 0, 1, 5, 7, false },	// lower left
+			{ 1, 2, 6, 8, true },	// bottom
+			{ 2, 3, 5, 7, false } };	// lower right
+
+		std::vector<int> masks(options.digits);
+		const auto h = band.second - band.first;
+		auto column = [&](double x) { return std::max(0, std::min(image.width, int(x + 0.5))); };
+		for (int cell = 0; cell < options.digits; ++cell) {
+			auto left = x0 + cell * w;
+			auto mask = 0;
+			for (int s = 0; s < 7; ++s) {
+				auto& r = regions[s];
+				auto coverage = getCoverage(image,
+					column(left + r.x0 * w / 3), column(left + r.x1 * w / 3),
+					band.first + r.y0 * h / 8, band.first + r.y1 * h / 8,
+					r.horizontal, options.threshold);
+				if (coverage >= options.coverage) mask |= 1 << s;
+			}
+			masks[cell] = mask;
+		}
+		return masks;
+	}
+}
+
+Bitmap readBitmap(std::istream& in)
+{
+	char magic[2] = {};
+	in.read(magic, 2);
+	if (!in || magic[0] != 'P' || magic[1] < '1' || magic[1] > '5' || magic[1] == '3')
+		throw std::runtime_error("not a PBM or PGM image");
+	auto type = magic[1] - '0';
+	auto bitmap = type == 1 || type == 4;
+
+	Bitmap image;
+	image.width = readNumber(in);
+	image.height = readNumber(in);
+	auto maxval = bitmap ? 1 : readNumber(in);
+	if (maxval <= 0 || maxval > 65535) throw std::runtime_error("malformed bitmap header");
+	const auto pixels = uint64_t(image.width) * image.height;
+	if (image.width == 0 || image.height == 0 || pixels > maxPixels) throw std::runtime_error("malformed bitmap header");
+
+	// the fewest bytes the raster can take, against what is left of a seekable stream,
+	// so a short file cannot claim a huge image
+	const auto least = type == 4 ? uint64_t((image.width + 7) / 8) * image.height : type == 5 && maxval > 255 ? 2 * pixels : pixels;
+	const auto at = in.tellg();
+	if (at != std::istream::pos_type(-1)) {
+		in.seekg(0, std::ios::end);
+		const auto end = in.tellg();
+		in.seekg(at);
+		if (end != std::istream::pos_type(-1) && uint64_t(end - at) < least) throw std::runtime_error("truncated bitmap");
+	}
+	image.pixels.resize(size_t(pixels));
+
+	if (type == 4) {
+		in.get();
+		std::vector<char> row((image.width + 7) / 8);
+		for (int y = 0; y < image.height; ++y) {
+			if (!in.read(row.data(), row.size())) throw std::runtime_error("truncated bitmap");
+			for (int x = 0; x < image.width; ++x) {
+				auto black = (row[x >> 3] >> (7 - (x & 7))) & 1;
+				image.pixels[size_t(y) * image.width + x] = black ? 0 : 255;
+			}
+		}
+	}
+	else if (type == 5) {
+		in.get();
+		auto bytes = maxval > 255 ? 2 : 1;
+		for (auto& p : image.pixels) {
+			int v = in.get();
+			if (bytes == 2) v = v << 8 | in.get();
+			if (!in || v > maxval) throw std::runtime_error("truncated bitmap");
+			p = (unsigned char)(v * 255 / maxval);
+		}
+	}
+	else {
+		for (auto& p : image.pixels) {
+			skipSpace(in);
+			int v = type == 1 ? in.get() - '0' : readNumber(in);
+			if (!in || v < 0 || v > maxval) throw std::runtime_error("truncated bitmap");
+			p = (unsigned char)(type == 1 ? (v ? 0 : 255) : v * 255 / maxval);
+		}
+	}
+	return image;
+}
+
+Bitmap loadBitmap(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in) throw std::runtime_error("cannot open " + path);
+	return readBitmap(in);
+}
+
+std::vector<std::pair<int, int>> findBands(const Bitmap& image, const RasterOptions& options)
+{
+	std::vector<std::pair<int, int>> bands;
+	auto top = -1, blank = 0;
+	for (int y = 0; y < image.height; ++y) {
+		auto ink = false;
+		for (int x = 0; x < image.width && !ink; ++x) ink = image.at(x, y) < options.threshold;
+		if (ink) {
+			if (top < 0) top = y;
+			blank = 0;
+		}
+		else if (top >= 0 && ++blank >= options.minGap) {
+			bands.emplace_back(top, y + 1 - blank);
+			top = -1;
+		}
+	}
+	if (top >= 0) bands.emplace_back(top, image.height - blank);
+	return bands;
+}
+
+std::vector<int> getStrokeMasks(const Bitmap& image, std::pair<int, int> band, const RasterOptions& options, const GlyphSet& glyphs)
+{
+	if (options.digits <= 0) throw std::invalid_argument("no digits per band");
+
+	// ink columns of the band, found like the bands themselves
+	auto left = -1, right = -1;
+	for (int x = 0; x < image.width; ++x) {
+		auto ink = false;
+		for (int y = band.first; y < band.second && !ink; ++y) ink = image.at(x, y) < options.threshold;
+		if (ink) {
+			if (left < 0) left = x;
+			right = x + 1;
+		}
+	}
+	if (left < 0) return std::vector<int>(options.digits);
+
+	// every glyph has a stroke in its right column, but the first one may leave its left
+	// column (1) or its left two (1, 3, 7 have none left of the middle) blank: the span
+	// is tried as starting one or two thirds of a cell further left, the most legible wins
+	std::vector<int> best;
+	auto bestLegible = -1;
+	for (int thirds = 0; thirds < 3; ++thirds) {
+		auto w = double(right - left) / (options.digits - thirds / 3.0);
+		auto masks = getCellMasks(image, band, right - options.digits * w, w, options);
+		auto legible = int(std::count_if(masks.begin(), masks.end(), [&](int m) { return glyphs.getDigit(m) >= 0; }));
+		if (legible > bestLegible) {
+			best = masks;
+			bestLegible = legible;
+		}
+	}
+	return best;
+}
+
+std::vector<std::vector<int>> readBands(const Bitmap& image, const GlyphSet& glyphs, const RasterOptions& options)
+{
+	std::vector<std::vector<int>> result;
+	for (auto band : findBands(image, options)) {
+		auto digits = getStrokeMasks(image, band, options, glyphs);
+		for (auto& d : digits) d = glyphs.getDigit(d);
+		result.push_back(digits);
+	}
+	return result;
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "OCR.h"
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// grey scan image, 0 is black and 255 white
+struct Bitmap
+{
+	int width = 0;
+	int height = 0;
+	std::vector<unsigned char> pixels;
+
+	unsigned char at(int x, int y) const { return pixels[size_t(y) * width + x]; }
+};
+
+// PBM (P1, P4) or PGM (P2, P5), throws std::runtime_error for other or broken files,
+// samples above maxval and images of no or more than 2^28 pixels
+Bitmap readBitmap(std::istream& in);
+Bitmap loadBitmap(const std::string& path);
+
+struct RasterOptions
+{
+	// pixels darker than this are ink
+	int threshold = 128;
+	// share of ink a row (horizontal) or column (vertical) of a segment region needs
+	double coverage = 0.6;
+	// blank rows separating two bands
+	int minGap = 3;
+	// glyphs per band, spread evenly over the ink of the band
+	int digits = 9;
+};
+
+// first and one past last row of each band of ink
+std::vector<std::pair<int, int>> findBands(const Bitmap& image, const RasterOptions& options = RasterOptions());
+
+// stroke masks of the glyph cells of a band, bit order of GlyphSet::getMask; the cells
+// divide the columns the band has ink in, so margins do not matter, and glyphs decides
+// where the first cell starts if its left column is blank; throws std::invalid_argument
+// unless options.digits is positive
+std::vector<int> getStrokeMasks(const Bitmap& image, std::pair<int, int> band,
+	const RasterOptions& options = RasterOptions(), const GlyphSet& glyphs = OCR::getGlyphSet());
+
+// digits of every band
+std::vector<std::vector<int>> readBands(const Bitmap& image,
+	const GlyphSet& glyphs = OCR::getGlyphSet(), const RasterOptions& options = RasterOptions());
@@ -0,0 +1,36 @@
+#include "Checksum.h"
+#include <cassert>
+
+int ChecksumScheme::getSum(const std::vector<int>& in) const
+{
+	assert(size_t(length) == in.size());
+	auto ret = 0;
+	for (int p = 0; p < length; ++p) ret += weights[p * 10 + in[p]];
+	return ret;
+}
+
+const ChecksumScheme& ChecksumScheme::getMod11()
+{
+	static const ChecksumKernel<WeightedMod11<9>, 9> scheme("mod11");
+	return scheme;
+}
+
+const ChecksumScheme& ChecksumScheme::getLuhn()
+{
+	static const ChecksumKernel<Luhn<9>, 9> scheme("luhn");
+	return scheme;
+}
+
+const ChecksumScheme& ChecksumScheme::getMod97()
+{
+	static const ChecksumKernel<Mod97<9>, 9> scheme("mod97");
+	return scheme;
+}
+
+const ChecksumScheme* ChecksumScheme::find(const std::string& name)
+{
+	for (auto scheme : { &getMod11(), &getLuhn(), &getMod97() }) {
+		if (scheme->getName() == name) return scheme;
+	}
+	return nullptr;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// checksum policies: the digit weights summed modulo 'modulus' have to equal 'target',
+// weight(pos, digit) is the contribution of a digit, so a replaced digit changes the sum
+// by weight(pos, new) - weight(pos, old)
+
+// kata rule: (Digits - pos) * digit, modulo 11
+template <int Digits>
+struct WeightedMod11
+{
+	static const int modulus = 11;
+	static const int target = 0;
+	static int weight(int pos, int digit) { return (Digits - pos) * digit; }
+};
+
+// Luhn: every second digit from the right doubled, digit sum of the product, modulo 10
+template <int Digits>
+struct Luhn
+{
+	static const int modulus = 10;
+	static const int target = 0;
+	static int weight(int pos, int digit) {
+		return ((Digits - 1 - pos) & 1) ? 2 * digit - 9 * (digit > 4) : digit;
+	}
+};
+
+// IBAN style: the account as number modulo 97 has to be 1
+template <int Digits>
+struct Mod97
+{
+	static const int modulus = 97;
+	static const int target = 1;
+	static int weight(int pos, int digit) { return digit * getPower(Digits - 1 - pos); }
+
+private:
+	// 10^k mod 97
+	static constexpr int getPower(int k) { return k == 0 ? 1 : getPower(k - 1) * 10 % 97; }
+};
+
+// run time selectable checksum: a table of the digit weights for O(1) residue updates,
+// and a batch kernel specialised per scheme
+class ChecksumScheme
+{
+public:
+	virtual ~ChecksumScheme() = default;
+
+	const std::string& getName() const { return name; }
+	int getLength() const { return length; }
+
+	// unreduced sum, in has to be legible
+	int getSum(const std::vector<int>& in) const;
+	// distance of the sum to the target, 0 for valid accounts
+	int getResidue(int sum) const {
+		auto r = (sum - target) % modulus;
+		return r < 0 ? r + modulus : r;
+	}
+	int getCheckSum(const std::vector<int>& in) const { return getResidue(getSum(in)); }
+	// change of the sum when the digit at pos is replaced
+	int getDelta(int pos, int from, int to) const { return weights[pos * 10 + to] - weights[pos * 10 + from]; }
+
+	// residues of 'count' accounts stored as getLength() consecutive digit bytes each
+	virtual void getCheckSums(const unsigned char* digits, size_t count, unsigned char* residues) const = 0;
+
+	// 9 digit built in schemes
+	static const ChecksumScheme& getMod11();
+	static const ChecksumScheme& getLuhn();
+	static const ChecksumScheme& getMod97();
+	// "mod11", "luhn" or "mod97", nullptr for others
+	static const ChecksumScheme* find(const std::string& name);
+
+protected:
+	ChecksumScheme(const std::string& name, int length, int modulus, int target)
+		: name(name), length(length), modulus(modulus), target(target), weights(10 * length) {}
+
+	std::string name;
+	int length;
+	int modulus;
+	int target;
+	std::vector<int> weights;
+};
+
+// the scheme of a checksum policy for accounts of 'Digits' digits
+template <class Policy, int Digits>
+class ChecksumKernel : public ChecksumScheme
+{
+public:
+	explicit ChecksumKernel(const std::string& name)
+		: ChecksumScheme(name, Digits, Policy::modulus, Policy::target)
+	{
+		for (int p = 0; p < Digits; ++p) {
+			for (int d = 0; d < 10; ++d) weights[p * 10 + d] = Policy::weight(p, d);
+		}
+	}
+
+	void getCheckSums(const unsigned char* digits, size_t count, unsigned char* residues) const override {
+		// blocks of accounts summed position by position, the inner loop has no dependencies
+		const size_t block = 64;
+		int sums[block];
+		for (size_t first = 0; first < count; first += block) {
+			auto n = count - first < block ? count - first : block;
+			auto in = digits + first * Digits;
+			for (size_t i = 0; i < n; ++i) sums[i] = 0;
+			for (int p = 0; p < Digits; ++p) {
+				for (size_t i = 0; i < n; ++i) sums[i] += Policy::weight(p, in[i * Digits + p]);
+			}
+			for (size_t i = 0; i < n; ++i) residues[first + i] = (unsigned char)getResidue(sums[i]);
+		}
+	}
+};
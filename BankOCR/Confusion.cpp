@@ -0,0 +1,105 @@
+#include "Confusion.h"
+#include "OCR.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+	const int costScale = 256;
+
+	// -log2 P(scanned 'read' | printed 'actual')
+	double getBits(const std::array<double, 7>& add, const std::array<double, 7>& drop, int read, int actual) {
+		auto r = OCR::getStrokes(read), a = OCR::getStrokes(actual);
+		auto bits = 0.0;
+		for (int s = 0; s < 7; ++s) {
+			bool inRead = (r >> s) & 1, inActual = (a >> s) & 1;
+			double p = inActual ? (inRead ? 1 - drop[s] : drop[s]) : (inRead ? add[s] : 1 - add[s]);
+			bits -= std::log2(p);
+		}
+		return bits;
+	}
+}
+
+ConfusionModel::ConfusionModel()
+	: ConfusionModel({ { .05, .05, .05, .05, .05, .05, .05 } }, { { .05, .05, .05, .05, .05, .05, .05 } })
+{
+}
+
+ConfusionModel::ConfusionModel(const std::array<double, 7>& add, const std::array<double, 7>& drop, double marginBits)
+	: add(add), drop(drop), marginBits(marginBits), margin(int(std::lround(marginBits * costScale)))
+{
+	for (int s = 0; s < 7; ++s) {
+		if (!(add[s] > 0 && add[s] < 1 && drop[s] > 0 && drop[s] < 1))
+			throw std::invalid_argument("stroke probabilities must be in (0, 1)");
+	}
+	for (int read = 0; read < 10; ++read) {
+		auto trust = getBits(add, drop, read, read);
+		for (int actual = 0; actual < 10; ++actual) {
+			auto cost = std::lround((getBits(add, drop, read, actual) - trust) * costScale);
+			repairCost[read][actual] = short(std::max(-32767L, std::min(32767L, cost)));
+		}
+	}
+}
+
+std::string ConfusionModel::toString() const
+{
+	std::ostringstream out;
+	out << "add";
+	for (auto p : add) out << ' ' << p;
+	out << "\ndrop";
+	for (auto p : drop) out << ' ' << p;
+	out << "\nmargin " << marginBits << '\n';
+	return out.str();
+}
+
+ConfusionModel ConfusionModel::parse(const std::string& text)
+{
+	std::istringstream in(text);
+	std::array<double, 7> add, drop;
+	double marginBits = 4.0;
+	bool hasAdd = false, hasDrop = false;
+	std::string key;
+	while (in >> key) {
+		if (key == "add" || key == "drop") {
+			auto& p = key == "add" ? add : drop;
+			for (auto& v : p) in >> v;
+			(key == "add" ? hasAdd : hasDrop) = true;
+		}
+		else if (key == "margin") in >> marginBits;
+		else throw std::invalid_argument("unknown confusion model key: " + key);
+		if (!in) throw std::invalid_argument("malformed confusion model: " + key);
+	}
+	if (!hasAdd || !hasDrop) throw std::invalid_argument("confusion model needs add and drop");
+	return ConfusionModel(add, drop, marginBits);
+}
+
+ConfusionModel trainConfusionModel(const std::vector<Correction>& corpus, double marginBits)
+{
+	// Laplace smoothed counts of strokes the scanner added / dropped
+	std::array<int, 7> added{}, dropped{}, absent{}, present{};
+	for (auto& c : corpus) {
+		if (c.read.size() != c.confirmed.size()) continue;
+		for (size_t i = 0; i < c.read.size(); ++i) {
+			if (c.read[i] < 0 || c.confirmed[i] < 0) continue;
+			auto r = OCR::getStrokes(c.read[i]), a = OCR::getStrokes(c.confirmed[i]);
+			for (int s = 0; s < 7; ++s) {
+				bool inRead = (r >> s) & 1;
+				if ((a >> s) & 1) {
+					++present[s];
+					if (!inRead) ++dropped[s];
+				}
+				else {
+					++absent[s];
+					if (inRead) ++added[s];
+				}
+			}
+		}
+	}
+	std::array<double, 7> add, drop;
+	for (int s = 0; s < 7; ++s) {
+		add[s] = (added[s] + 1.0) / (absent[s] + 2.0);
+		drop[s] = (dropped[s] + 1.0) / (present[s] + 2.0);
+	}
+	return ConfusionModel(add, drop, marginBits);
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+
+// per stroke probabilities that the scanner added or dropped a stroke,
+// folded into a digit x digit table of repair costs
+class ConfusionModel
+{
+public:
+	static const int maxCost = 1 << 30;
+
+	// every stroke equally likely => never prefers one candidate over another
+	ConfusionModel();
+	ConfusionModel(const std::array<double, 7>& add, const std::array<double, 7>& drop, double marginBits = 4.0);
+
+	// cost (1/256 bit) of assuming 'actual' was printed where 'read' was scanned,
+	// relative to trusting the scan
+	int getRepairCost(int read, int actual) const { return repairCost[read][actual]; }
+	// a candidate must be this much cheaper than the next one to fix an AMB entry
+	int getMargin() const { return margin; }
+
+	double getAdd(int stroke) const { return add[stroke]; }
+	double getDrop(int stroke) const { return drop[stroke]; }
+
+	// "add p0..p6\ndrop p0..p6\nmargin bits\n"
+	std::string toString() const;
+	static ConfusionModel parse(const std::string& text);
+
+private:
+	std::array<double, 7> add;
+	std::array<double, 7> drop;
+	double marginBits;
+	int margin;
+	short repairCost[10][10];
+};
+
+// a scanned account and the account confirmed by an operator
+struct Correction
+{
+	std::vector<int> read;
+	std::vector<int> confirmed;
+};
+
+ConfusionModel trainConfusionModel(const std::vector<Correction>& corpus, double marginBits = 4.0);
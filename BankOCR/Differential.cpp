@@ -0,0 +1,450 @@
+#include "Differential.h"
+#include "Batch.h"
+#include "Format.h"
+#include "OCR.h"
+#include "Sliced.h"
+#include "Swar.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+// the first version of the kata, verbatim apart from the namespace, so the oracle shares
+// no code with the engines under test
+namespace baseline {
+class OCR
+{
+public:
+	// multiline string => vector of digits
+	static std::vector<int> read(const std::string& input);
+
+
+	static std::string getPos(const std::string& input, int i);
+	static int getNumber(const std::string& str);
+};
+
+std::vector<int> OCR::read(const std::string& input)
+{
+	assert(4 * 27 == input.size());
+	std::vector<int> result;
+	for (int i = 0; i < 9; ++i) {
+		std::string sign = getPos(input, i);
+		result.push_back( getNumber(sign) );
+	}
+	return result;
+}
+
+namespace {
+	std::string charArray[10] = {
+		" _ "
+		"| |"
+		"|_|",
+		"   "
+		"  |"
+		"  |",
+		" _ "
+		" _|"
+		"|_ ",
+		" _ "
+		" _|"
+		" _|",
+		"   "
+		"|_|"
+		"  |",
+		" _ "
+		"|_ "
+		" _|",
+		" _ "
+		"|_ "
+		"|_|",
+		" _ "
+		"  |"
+		"  |",
+		" _ "
+		"|_|"
+		"|_|",
+		" _ "
+		"|_|"
+		" _|" };
+}
+
+std::string OCR::getPos(const std::string& input, int i) {
+	return 
+		input.substr(i * 3, 3)
+		+ input.substr(27 + i* 3, 3) 
+		+ input.substr(2*27 + i * 3, 3);
+}
+
+int OCR::getNumber(const std::string& str) {
+	auto i = 0;
+	for (auto ch : charArray) {
+		if (ch == str) return i;
+		i++;
+	}
+	return -1;
+}
+
+
+int getCheckSum(const std::vector<int>& in) {
+	auto ret = 0, p = 0;
+	for (auto v : in) ret += (9 - p++) * v;
+	return ret % 11;
+}
+
+std::vector<std::vector<int>> replacements = { { 8 },{ 7 },{},{ 9 },{},{ 6,9 },{},{ 1 },{ 0,6,9 },{ 3,5,8 } };
+
+std::vector<std::vector<int>> checkReplace(std::vector<int> in)
+{
+	std::vector<std::vector<int>> results;
+	for (auto &i : in) {
+		int org = i;
+		for (auto r : replacements[i])
+		{
+			i = r;
+			if (getCheckSum(in) == 0 ) {
+				results.push_back( in );
+				if (results.size() > 1) {
+					return results;
+				}
+			};
+		}
+		i = org;
+	}
+	return results;
+}
+
+std::string getCheckPlus(const std::vector<int>& in)
+{
+	std::string ret = "";
+	for (int i : in) ret += i < 0 ? '?' : '0' + i;
+
+	for (auto n : in) {
+		if (n < 0) return ret + " ILL";
+	}
+	if (0 == getCheckSum(in)) return ret;
+	auto v = checkReplace(in);
+
+	if (v.empty()) return ret + " ERR";
+	if (v.size() != 1) return ret + " AMB";
+
+	ret = "";
+	for (int i : v[0]) ret += '0' + i;
+	return ret + " FIX";
+}
+}
+
+namespace {
+	const size_t entrySize = 4 * OCR::width;
+	// cell positions of the strokes and their bytes
+	const int strokePos[7] = { 1, 3, 4, 5, 6, 7, 8 };
+	// bytes the exact decoder rejects, none the archive framing treats as blank
+	const char noise[] = { 'x', '!', 'l', 'I', '.', '#', 'o', '\0', '\x01', '\x7f', '\xff' };
+
+	char getStrokeByte(int p) {
+		return p == 1 || p == 4 || p == 7 ? '_' : '|';
+	}
+
+	char& at(std::string& entry, int cell, int p) {
+		return entry[p / 3 * OCR::width + 3 * cell + p % 3];
+	}
+
+	std::vector<std::string> split(const std::string& text) {
+		std::vector<std::string> lines;
+		std::istringstream in(text);
+		for (std::string line; std::getline(in, line);) lines.push_back(line);
+		return lines;
+	}
+
+	class EntryGenerator
+	{
+	public:
+		explicit EntryGenerator(uint64_t seed) : rng(seed) {}
+
+		std::string next() {
+			std::string entry(entrySize, ' ');
+			switch (rng() % 8) {
+			case 0:
+			case 1:
+				put(entry, getRandom());
+				break;
+			case 2:
+				put(entry, getValid());
+				break;
+			case 3:
+				// FIX and AMB material
+				put(entry, getValid());
+				toggleStroke(entry);
+				break;
+			case 4:
+				put(entry, getRandom());
+				for (auto n = 1 + rng() % 3; n; --n) entry[rng() % entrySize] = noise[rng() % sizeof(noise)];
+				break;
+			case 5:
+				// shapes that are mostly no digit
+				for (int i = 0; i < OCR::digits; ++i) {
+					auto mask = rng() % 128;
+					for (int s = 0; s < 7; ++s) {
+						if (mask >> s & 1) at(entry, i, strokePos[s]) = getStrokeByte(strokePos[s]);
+					}
+				}
+				break;
+			case 6:
+				// a stroke byte in a corner, the wrong stroke or the ignored fourth line
+				put(entry, getRandom());
+				if (rng() % 2) at(entry, int(rng() % OCR::digits), int(rng() % 9)) = rng() % 2 ? '|' : '_';
+				else entry[3 * OCR::width + rng() % OCR::width] = rng() % 2 ? '|' : '_';
+				break;
+			default:
+				put(entry, getRandom());
+				toggleStroke(entry);
+				toggleStroke(entry);
+			}
+			return entry;
+		}
+
+	private:
+		std::vector<int> getRandom() {
+			std::vector<int> digits(OCR::digits);
+			for (auto& d : digits) d = int(rng() % 10);
+			return digits;
+		}
+
+		// the last digit has weight 1, so it can close the mod 11 sum unless that needs a 10
+		std::vector<int> getValid() {
+			for (;;) {
+				auto digits = getRandom();
+				digits.back() = 0;
+				auto last = (11 - baseline::getCheckSum(digits)) % 11;
+				if (last < 10) {
+					digits.back() = last;
+					return digits;
+				}
+			}
+		}
+
+		void put(std::string& entry, const std::vector<int>& digits) {
+			entry = OCR::render(digits);
+		}
+
+		void toggleStroke(std::string& entry) {
+			auto p = strokePos[rng() % 7];
+			auto& c = at(entry, int(rng() % OCR::digits), p);
+			c = c == ' ' ? getStrokeByte(p) : ' ';
+		}
+
+		std::mt19937_64 rng;
+	};
+
+	// getResult of every entry through a formatter, one line per entry
+	template <class Format>
+	std::vector<std::string> formatLines(const std::vector<std::string>& entries, Format format) {
+		std::vector<Result> results;
+		for (auto& e : entries) results.push_back(getResult(OCR::read(e)));
+		std::vector<char> text(getFormatSize(results.size()));
+		auto size = format(results.data(), results.size(), text.data());
+		return split(std::string(text.data(), size));
+	}
+
+	template <class F>
+	std::vector<std::string> perEntry(const std::vector<std::string>& entries, F f) {
+		std::vector<std::string> out;
+		for (auto& e : entries) out.push_back(f(e));
+		return out;
+	}
+}
+
+std::string getReferenceDigits(const std::string& entry)
+{
+	std::string ret;
+	for (auto d : baseline::OCR::read(entry)) ret += d < 0 ? '?' : char('0' + d);
+	return ret;
+}
+
+std::string getReferenceLine(const std::string& entry)
+{
+	return baseline::getCheckPlus(baseline::OCR::read(entry));
+}
+
+std::string getReferenceValid(const std::string& entry)
+{
+	auto digits = baseline::OCR::read(entry);
+	auto legible = std::find(digits.begin(), digits.end(), -1) == digits.end();
+	return legible && baseline::getCheckSum(digits) == 0 ? "valid" : "invalid";
+}
+
+std::vector<DifferentialEngine> getDifferentialEngines(const std::string& tempPath)
+{
+	typedef std::vector<std::string> Entries;
+	return {
+		{ "read (table)", [](const Entries& entries) {
+			return perEntry(entries, [](const std::string& e) { return OCR::getDigits(OCR::read(e)); });
+		}, getReferenceDigits },
+		{ "read into array", [](const Entries& entries) {
+			return perEntry(entries, [](const std::string& e) {
+				int digits[OCR::digits];
+				OCR::read(e.data(), digits);
+				return OCR::getDigits(std::vector<int>(digits, digits + OCR::digits));
+			});
+		}, getReferenceDigits },
+		{ "readBand", [](const Entries& entries) {
+			// the block side by side in one band
+			std::string band;
+			for (int row = 0; row < 4; ++row) {
+				for (auto& e : entries) band.append(e, row * OCR::width, OCR::width);
+			}
+			Entries out;
+			for (auto& digits : OCR::readBand(band)) out.push_back(OCR::getDigits(digits));
+			return out;
+		}, getReferenceDigits },
+		{ "readSwar", [](const Entries& entries) {
+			return perEntry(entries, [](const std::string& e) { return OCR::getDigits(readSwar(e)); });
+		}, getReferenceDigits },
+		{ "readSwar into array", [](const Entries& entries) {
+			return perEntry(entries, [](const std::string& e) {
+				int digits[OCR::digits];
+				readSwar(e.data(), digits);
+				return OCR::getDigits(std::vector<int>(digits, digits + OCR::digits));
+			});
+		}, getReferenceDigits },
+		{ "readSliced", [](const Entries& entries) {
+			Entries out;
+			for (auto& digits : readSliced(entries)) out.push_back(OCR::getDigits(digits));
+			return out;
+		}, getReferenceDigits },
+		{ "readSliced checksum", [](const Entries& entries) {
+			std::vector<bool> valid;
+			readSliced(entries, &valid);
+			Entries out;
+			for (auto v : valid) out.push_back(v ? "valid" : "invalid");
+			return out;
+		}, getReferenceValid },
+		{ "getCheckPlus", [](const Entries& entries) {
+			return perEntry(entries, [](const std::string& e) { return getCheckPlus(OCR::read(e)); });
+		}, getReferenceLine },
+		{ "getCheckPlus (scheme)", [](const Entries& entries) {
+			RepairOptions options;
+			options.checksum = &ChecksumScheme::getMod11();
+			return perEntry(entries, [&](const std::string& e) { return getCheckPlus(OCR::read(e), options); });
+		}, getReferenceLine },
+		{ "getCheckPlus (glyph set)", [](const Entries& entries) {
+			RepairOptions options;
+			options.glyphs = &OCR::getGlyphSet();
+			return perEntry(entries, [&](const std::string& e) { return getCheckPlus(OCR::read(e), options); });
+		}, getReferenceLine },
+		{ "formatResults", [](const Entries& entries) {
+			return formatLines(entries, formatResults);
+		}, getReferenceLine },
+		{ "formatResultsPortable", [](const Entries& entries) {
+			return formatLines(entries, formatResultsPortable);
+		}, getReferenceLine },
+		{ "formatFixed", [](const Entries& entries) {
+			auto lines = formatLines(entries, formatFixed);
+			for (auto& line : lines) line.erase(line.find_last_not_of(' ') + 1);
+			return lines;
+		}, getReferenceLine },
+		{ "runBatch", [tempPath](const Entries& entries) {
+			{
+				// a legible last entry, so blank entries are not trimmed off the end
+				std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+				for (auto& e : entries) {
+					for (int row = 0; row < 4; ++row) out << e.substr(row * OCR::width, OCR::width) << "\n";
+				}
+				out << std::string(KataFont::glyphs[1], 3) << "\n" << std::string(KataFont::glyphs[1] + 3, 3) << "\n"
+					<< std::string(KataFont::glyphs[1] + 6, 3) << "\n\n";
+			}
+			runBatch(tempPath, tempPath + ".out");
+			std::ifstream in(tempPath + ".out", std::ios::binary);
+			std::ostringstream text;
+			text << in.rdbuf();
+			in.close();
+			std::remove(tempPath.c_str());
+			std::remove((tempPath + ".out").c_str());
+			auto lines = split(text.str());
+			if (!lines.empty()) lines.pop_back();
+			return lines;
+		}, getReferenceLine },
+	};
+}
+
+std::string DifferentialReport::toString() const
+{
+	std::ostringstream out;
+	if (!failed) {
+		out << entries << " entries, no mismatch (seed " << seed << ")\n";
+		return out.str();
+	}
+	out << "mismatch in " << engine << " after " << entries << " entries (seed " << seed << "), minimised input:\n";
+	for (size_t row = 0; row < 4; ++row) {
+		out << "  |";
+		for (size_t c = row * OCR::width; c < (row + 1) * OCR::width && c < input.size(); ++c) {
+			auto b = (unsigned char)input[c];
+			if (b >= 0x20 && b < 0x7f) out << char(b);
+			else {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\x%02x", b);
+				out << escaped;
+			}
+		}
+		out << "|\n";
+	}
+	out << "expected: " << expected << "\nactual:   " << actual << "\n";
+	return out.str();
+}
+
+DifferentialReport runDifferential(const DifferentialOptions& options, const std::vector<DifferentialEngine>& engines)
+{
+	DifferentialReport report;
+	report.seed = options.seed;
+	EntryGenerator generator(options.seed);
+	const auto start = std::chrono::steady_clock::now();
+	const auto block = std::max<size_t>(1, options.block);
+	std::vector<std::string> entries;
+	while (!options.entries || report.entries < options.entries) {
+		auto n = options.entries ? size_t(std::min<uint64_t>(block, options.entries - report.entries)) : block;
+		entries.clear();
+		for (size_t i = 0; i < n; ++i) entries.push_back(generator.next());
+
+		for (auto& engine : engines) {
+			auto out = engine.run(entries);
+			for (size_t i = 0; i < n; ++i) {
+				auto actual = i < out.size() ? out[i] : "<missing>";
+				if (actual == engine.reference(entries[i])) continue;
+
+				// alone, with every byte blanked that the mismatch persists without
+				auto fails = [&](const std::string& entry) {
+					auto alone = engine.run({ entry });
+					return alone.empty() || alone[0] != engine.reference(entry);
+				};
+				auto entry = entries[i];
+				if (fails(entry)) {
+					for (auto changed = true; changed;) {
+						changed = false;
+						for (auto& c : entry) {
+							if (c == ' ') continue;
+							auto kept = c;
+							c = ' ';
+							if (fails(entry)) changed = true;
+							else c = kept;
+						}
+					}
+					auto alone = engine.run({ entry });
+					actual = alone.empty() ? "<missing>" : alone[0];
+				}
+				report.failed = true;
+				report.entries += i;
+				report.engine = engine.name;
+				report.input = entry;
+				report.expected = engine.reference(entry);
+				report.actual = actual;
+				return report;
+			}
+		}
+		report.entries += n;
+		std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+		if (options.seconds > 0 && took.count() >= options.seconds) break;
+	}
+	return report;
+}
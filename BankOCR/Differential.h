@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// differential testing of the engines against the reference behaviour downstream relies on:
+// the first version of OCR::read and getCheckPlus, kept verbatim as the oracle
+
+// an engine maps a block of entries (4 * OCR::width bytes each) to one text per entry,
+// compared with reference(entry)
+struct DifferentialEngine
+{
+	const char* name;
+	std::function<std::vector<std::string>(const std::vector<std::string>& entries)> run;
+	std::function<std::string(const std::string& entry)> reference;
+};
+
+// reference texts: the digits with '?' for illegible cells, the getCheckPlus line,
+// and "valid" or "invalid" for the checksum of legible entries
+std::string getReferenceDigits(const std::string& entry);
+std::string getReferenceLine(const std::string& entry);
+std::string getReferenceValid(const std::string& entry);
+
+// table, row and SWAR decoders, the bit sliced decoder and its checksum, getCheckPlus with
+// and without a checksum scheme or the kata glyph set, getResult formatted by the SSE2,
+// portable and fixed width formatters, and runBatch over an archive written to tempPath
+std::vector<DifferentialEngine> getDifferentialEngines(const std::string& tempPath = "differential.txt");
+
+struct DifferentialOptions
+{
+	uint64_t seed = 2017;
+	// generated entries, 0 for no limit
+	uint64_t entries = 1 << 16;
+	// stops after the first block past this, 0 for no limit
+	double seconds = 0;
+	// entries per engine call
+	size_t block = 4096;
+};
+
+struct DifferentialReport
+{
+	uint64_t seed = 0;
+	// checked before the mismatch
+	uint64_t entries = 0;
+	bool failed = false;
+	// of the first mismatch: the engine, its entry (4 * OCR::width bytes) reduced to the
+	// bytes the mismatch needs, and both texts for that entry
+	std::string engine;
+	std::string input;
+	std::string expected;
+	std::string actual;
+
+	// "<n> entries, no mismatch" or the mismatch
+	std::string toString() const;
+};
+
+// generated entries (random, checksum valid, one stroke off, noisy bytes, odd shapes)
+// through every engine until the first mismatch, which is minimised by blanking every
+// byte the mismatch persists without
+DifferentialReport runDifferential(const DifferentialOptions& options = DifferentialOptions(),
+	const std::vector<DifferentialEngine>& engines = getDifferentialEngines());
@@ -0,0 +1,92 @@
+#include "Drift.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+	const int width = OCR::width;
+
+	int countLegible(const std::vector<int>& digits) {
+		return int(std::count_if(digits.begin(), digits.end(), [](int d) { return d >= 0; }));
+	}
+
+	// votes for the column residue (0..2) of the shift of a row,
+	// strokes sit at columns 3i+1 ('_') and 3i, 3i+2 ('|')
+	void addVotes(const char* row, const ByteClasses& classes, int votes[3]) {
+		for (int c = 0; c < width; ++c) {
+			auto cls = classes.get(row[c]);
+			for (int s = 0; s < 3; ++s) {
+				auto col = (c - s + 3) % 3;
+				if (cls == ByteClasses::underscore && col == 1) ++votes[s];
+				if (cls == ByteClasses::pipe && col != 1) ++votes[s];
+			}
+		}
+	}
+
+	// residue with most votes, ties go to 'preferred'
+	int getResidue(const int votes[3], int preferred) {
+		auto best = preferred;
+		for (int s = 0; s < 3; ++s) {
+			if (votes[s] > votes[best]) best = s;
+		}
+		return best;
+	}
+
+	std::vector<int> readShifted(const std::string& input, const int shift[3], const GlyphSet& glyphs, const ByteClasses& classes) {
+		std::string aligned(input.size(), ' ');
+		for (int r = 0; r < 3; ++r) {
+			for (int c = 0; c < width; ++c) {
+				auto from = c + shift[r];
+				if (from >= 0 && from < width) aligned[r * width + c] = input[r * width + from];
+			}
+		}
+		return OCR::read(aligned, glyphs, classes);
+	}
+}
+
+std::vector<int> readRealigned(const std::string& input, DriftStats& stats, const GlyphSet& glyphs, const ByteClasses& classes)
+{
+	assert(4 * width == input.size());
+	++stats.entries;
+	auto result = OCR::read(input, glyphs, classes);
+	auto legible = countLegible(result);
+	if (legible == OCR::digits) return result;
+
+	// the whole entry decides, single rows only if their own strokes disagree
+	int votes[3][3] = {}, total[3] = {};
+	for (int r = 0; r < 3; ++r) {
+		addVotes(input.data() + r * width, classes, votes[r]);
+		for (int s = 0; s < 3; ++s) total[s] += votes[r][s];
+	}
+	int residue[3];
+	auto entry = getResidue(total, 0);
+	for (int r = 0; r < 3; ++r) residue[r] = getResidue(votes[r], entry);
+	if (residue[0] == 0 && residue[1] == 0 && residue[2] == 0) return result;
+
+	// a residue of 1 is a shift of +1 or -2, 2 is -1 or +2
+	static const int candidates[3][2] = { { 0, 0 }, { 1, -2 }, { -1, 2 } };
+	int best[3] = {};
+	for (int combo = 0; combo < 8; ++combo) {
+		int shift[3];
+		bool duplicate = false;
+		for (int r = 0; r < 3; ++r) {
+			auto pick = (combo >> r) & 1;
+			duplicate |= residue[r] == 0 && pick;
+			shift[r] = candidates[residue[r]][pick];
+		}
+		if (duplicate) continue;
+		auto digits = readShifted(input, shift, glyphs, classes);
+		auto n = countLegible(digits);
+		if (n > legible) {
+			legible = n;
+			result = digits;
+			std::copy(shift, shift + 3, best);
+		}
+	}
+
+	if (best[0] == 0 && best[1] == 0 && best[2] == 0) ++stats.unresolved;
+	else if (best[0] == best[1] && best[1] == best[2]) ++stats.entryShift[best[0] + 2];
+	else for (int r = 0; r < 3; ++r) {
+		if (best[r]) ++stats.rowShift[r][best[r] + 2];
+	}
+	return result;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "OCR.h"
+#include <cstdint>
+
+// how often read realigned shifted entries, indexed by shift + 2 (columns, positive = right)
+struct DriftStats
+{
+	uint64_t entries = 0;
+	uint64_t entryShift[5] = {};
+	uint64_t rowShift[3][5] = {};
+	// drift detected, but no alignment decoded better
+	uint64_t unresolved = 0;
+};
+
+// reads an entry, realigning a shifted entry or shifted rows (by up to 2 columns) before
+// returning illegible digits; the shift is guessed from the stroke columns, so only
+// entries with illegible digits and a detected drift are decoded again
+std::vector<int> readRealigned(const std::string& input, DriftStats& stats,
+	const GlyphSet& glyphs = OCR::getGlyphSet(), const ByteClasses& classes = ByteClasses::getExact());
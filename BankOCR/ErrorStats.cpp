@@ -0,0 +1,78 @@
+#include "ErrorStats.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+namespace {
+	const char* const statusNames[] = { "OK", "ERR", "ILL", "AMB", "FIX", "UNK" };
+
+	// (count, label) of the nonzero counters, most frequent first
+	std::vector<std::pair<uint64_t, int>> getRanking(const uint64_t* counts, int size) {
+		std::vector<std::pair<uint64_t, int>> ret;
+		for (int i = 0; i < size; ++i) {
+			if (counts[i]) ret.emplace_back(counts[i], i);
+		}
+		std::stable_sort(ret.begin(), ret.end(), [](const std::pair<uint64_t, int>& a, const std::pair<uint64_t, int>& b) { return a.first > b.first; });
+		return ret;
+	}
+}
+
+void ErrorStats::add(const std::string& entry, const std::vector<int>& digits, const Result& result)
+{
+	++status[int(result.status)];
+	if (result.status == Status::ill) {
+		for (int p = 0; p < OCR::digits; ++p) {
+			if (digits[p] >= 0) continue;
+			++illegible[p];
+			auto mask = GlyphSet::getMask(entry.data() + 3 * p, OCR::width);
+			if (mask < 0) ++noise;
+			else ++masks[mask];
+		}
+	}
+	else if (result.status == Status::fix) {
+		for (int p = 0; p < OCR::digits; ++p) {
+			if (digits[p] != result.digits[p]) ++fixes[digits[p]][result.digits[p]];
+		}
+	}
+}
+
+void ErrorStats::add(const Result& result)
+{
+	++status[int(result.status)];
+	if (result.status != Status::ill) return;
+	for (int p = 0; p < OCR::digits; ++p) illegible[p] += result.digits[p] == Result::illegible;
+}
+
+void ErrorStats::merge(const ErrorStats& other)
+{
+	for (int i = 0; i < 6; ++i) status[i] += other.status[i];
+	for (int p = 0; p < 9; ++p) illegible[p] += other.illegible[p];
+	noise += other.noise;
+	for (int m = 0; m < 128; ++m) masks[m] += other.masks[m];
+	for (int a = 0; a < 10; ++a) {
+		for (int b = 0; b < 10; ++b) fixes[a][b] += other.fixes[a][b];
+	}
+}
+
+uint64_t ErrorStats::getEntries() const
+{
+	uint64_t ret = 0;
+	for (auto n : status) ret += n;
+	return ret;
+}
+
+std::string ErrorStats::toString() const
+{
+	std::ostringstream out;
+	out << "entries " << getEntries() << "\nstatus";
+	for (int i = 0; i < 6; ++i) out << ' ' << statusNames[i] << ' ' << status[i];
+	out << "\nillegible";
+	for (auto n : illegible) out << ' ' << n;
+	out << "\nnoise " << noise << '\n';
+	for (auto& m : getRanking(masks, 128)) {
+		out << "mask 0x" << std::hex << std::setw(2) << std::setfill('0') << m.second << std::dec << ' ' << m.first << '\n';
+	}
+	for (auto& f : getRanking(&fixes[0][0], 100)) out << "fix " << f.second / 10 << '>' << f.second % 10 << ' ' << f.first << '\n';
+	return out.str();
+}
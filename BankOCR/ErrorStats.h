@@ -0,0 +1,32 @@
+#pragma once
+#include "OCR.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// error counters of a file for scanner quality reports, kept per worker while
+// decoding and merged; only illegible and fixed entries cost more than one increment
+struct ErrorStats
+{
+	uint64_t status[6] = {};
+	// illegible glyphs per position
+	uint64_t illegible[9] = {};
+	// illegible glyphs with a byte that is no stroke
+	uint64_t noise = 0;
+	// stroke masks of illegible glyphs that are no digit
+	uint64_t masks[128] = {};
+	// the scanned and the repaired digit of FIX entries
+	uint64_t fixes[10][10] = {};
+
+	// entry (4 * OCR::width bytes), its decoded digits and the reported result
+	void add(const std::string& entry, const std::vector<int>& digits, const Result& result);
+	// a result taken from elsewhere, counts the status and illegible positions only
+	void add(const Result& result);
+	void merge(const ErrorStats& other);
+
+	uint64_t getEntries() const;
+
+	// "entries n", "status OK n ERR n ...", "illegible n0 .. n8", "noise n", then one
+	// "mask 0xNN n" and "fix a>b n" line per nonzero counter, most frequent first
+	std::string toString() const;
+};
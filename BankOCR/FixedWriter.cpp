@@ -0,0 +1,112 @@
+#include "FixedWriter.h"
+#include "Format.h"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// records formatted per write
+	const size_t chunk = 4096;
+
+#ifdef _WIN32
+	class OutputFile
+	{
+	public:
+		OutputFile(const std::string& path, size_t size) {
+			file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot create " + path);
+			LARGE_INTEGER end;
+			end.QuadPart = LONGLONG(size);
+			if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+				CloseHandle(file);
+				throw std::runtime_error("cannot allocate " + path);
+			}
+		}
+		~OutputFile() { CloseHandle(file); }
+
+		bool write(const char* data, size_t size, size_t offset) const {
+			OVERLAPPED at = {};
+			at.Offset = DWORD(offset);
+			at.OffsetHigh = DWORD(uint64_t(offset) >> 32);
+			DWORD written = 0;
+			return WriteFile(file, data, DWORD(size), &written, &at) && written == size;
+		}
+
+	private:
+		HANDLE file;
+	};
+#else
+	class OutputFile
+	{
+	public:
+		OutputFile(const std::string& path, size_t size) {
+			fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0) throw std::runtime_error("cannot create " + path);
+			// reserve the blocks up front where the file system can, else just set the size
+			auto ok = false;
+#ifdef __linux__
+			ok = size == 0 || posix_fallocate(fd, 0, off_t(size)) == 0;
+#endif
+			if (!ok && ftruncate(fd, off_t(size)) != 0) {
+				::close(fd);
+				throw std::runtime_error("cannot allocate " + path);
+			}
+		}
+		~OutputFile() { ::close(fd); }
+
+		bool write(const char* data, size_t size, size_t offset) const {
+			while (size) {
+				auto n = pwrite(fd, data, size, off_t(offset));
+				if (n <= 0) return false;
+				data += n;
+				size -= size_t(n);
+				offset += size_t(n);
+			}
+			return true;
+		}
+
+	private:
+		int fd;
+	};
+#endif
+}
+
+void writeFixedResults(const std::string& path, const Result* results, size_t count, int threads, Tracer* trace)
+{
+	const OutputFile file(path, count * fixedRecord);
+	// chunks are handed out by a counter, their offsets follow from the index alone
+	std::atomic<size_t> next(0);
+	std::atomic<bool> failed(false);
+	const auto chunks = (count + chunk - 1) / chunk;
+	auto work = [&](int worker) {
+		if (trace) trace->setThreadName("fixed writer " + std::to_string(worker));
+		std::vector<char> buffer(chunk * fixedRecord);
+		for (size_t first; (first = next.fetch_add(chunk)) < count && !failed;) {
+			auto n = std::min(chunk, count - first);
+			if (trace) trace->counter("pending chunks", int64_t(chunks - first / chunk - 1));
+			size_t size;
+			{
+				TraceSpan span(trace, "format", "fixed", int64_t(n));
+				size = formatFixed(results + first, n, buffer.data());
+			}
+			TraceSpan span(trace, "write", "fixed", int64_t(size));
+			if (!file.write(buffer.data(), size, first * fixedRecord)) failed = true;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int t = 1; t < threads; ++t) workers.emplace_back(work, t);
+	work(0);
+	for (auto& w : workers) w.join();
+	if (failed) throw std::runtime_error("cannot write " + path);
+}
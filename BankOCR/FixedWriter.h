@@ -0,0 +1,13 @@
+#pragma once
+#include "OCR.h"
+#include "Trace.h"
+#include <cstddef>
+#include <string>
+
+// writes results as fixed width records (see formatFixed) into a file of the final size,
+// 'threads' workers format slices and write them at their offsets with positional writes,
+// no ordering between them; throws std::runtime_error if the file cannot be written
+//
+// with a tracer every worker records its format and write spans per chunk and samples the
+// chunks still waiting as the "pending chunks" counter
+void writeFixedResults(const std::string& path, const Result* results, size_t count, int threads, Tracer* trace = nullptr);
@@ -0,0 +1,94 @@
+#include "Format.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BANKOCR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+	// status text and newline per status, padded to one 8 byte store
+	struct Suffixes
+	{
+		char text[6][8];
+		size_t length[6];
+	};
+	const Suffixes plain = { { "\n", " ERR\n", " ILL\n", " AMB\n", " FIX\n", " UNK\n" }, { 1, 5, 5, 5, 5, 5 } };
+	const Suffixes padded = { { "    \n", " ERR\n", " ILL\n", " AMB\n", " FIX\n", " UNK\n" }, { 5, 5, 5, 5, 5, 5 } };
+
+	// the 9 digits, writes 8 bytes past them
+	void putDigitsPortable(const Result& r, char* out) {
+		const uint64_t ones = 0x0101010101010101ull;
+		uint64_t word;
+		std::memcpy(&word, r.digits, 8);
+		// 0xff in illegible bytes, the others hold 0..9 and add '0' without carries
+		auto x = ~word;
+		auto ill = (~(((x & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | x) & 0x8080808080808080ull) >> 7;
+		ill *= 0xff;
+		auto ascii = (((word & ~ill) + ones * '0') & ~ill) | (ones * '?' & ill);
+		std::memcpy(out, &ascii, 8);
+		out[8] = r.digits[8] == Result::illegible ? '?' : char('0' + r.digits[8]);
+	}
+
+#ifdef BANKOCR_SSE2
+	// the 9 digits of one record, 9 of the 16 lanes used; writes 7 bytes past them
+	void putDigitsVector(const Result& r, char* out) {
+		static_assert(sizeof(Result) == 16, "results are loaded as 16 byte vectors");
+		const auto zero = _mm_set1_epi8('0');
+		const auto unknown = _mm_set1_epi8('?');
+		const auto illegible = _mm_set1_epi8(char(Result::illegible));
+		auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&r));
+		auto ill = _mm_cmpeq_epi8(v, illegible);
+		auto ascii = _mm_or_si128(_mm_and_si128(ill, unknown), _mm_andnot_si128(ill, _mm_add_epi8(v, zero)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), ascii);
+	}
+#endif
+
+	// bytes written past a record are overwritten by the suffix and the next record
+	template <void (*PutDigits)(const Result&, char*)>
+	size_t format(const Result* results, size_t count, char* out, const Suffixes& suffixes) {
+		char* pos = out;
+		for (size_t i = 0; i < count; ++i) {
+			PutDigits(results[i], pos);
+			pos += 9;
+			auto s = int(results[i].status);
+			std::memcpy(pos, suffixes.text[s], 8);
+			pos += suffixes.length[s];
+		}
+		return size_t(pos - out);
+	}
+
+	// one record without writing past it
+	size_t putExact(const Result& r, char* out, const Suffixes& suffixes) {
+		for (int p = 0; p < 9; ++p) out[p] = r.digits[p] == Result::illegible ? '?' : char('0' + r.digits[p]);
+		auto s = int(r.status);
+		std::memcpy(out + 9, suffixes.text[s], suffixes.length[s]);
+		return 9 + suffixes.length[s];
+	}
+
+	void putDigits(const Result& r, char* out) {
+#ifdef BANKOCR_SSE2
+		putDigitsVector(r, out);
+#else
+		putDigitsPortable(r, out);
+#endif
+	}
+}
+
+size_t formatResults(const Result* results, size_t count, char* out)
+{
+	return format<putDigits>(results, count, out, plain);
+}
+
+size_t formatResultsPortable(const Result* results, size_t count, char* out)
+{
+	return format<putDigitsPortable>(results, count, out, plain);
+}
+
+size_t formatFixed(const Result* results, size_t count, char* out)
+{
+	if (!count) return 0;
+	auto n = format<putDigits>(results, count - 1, out, padded);
+	return n + putExact(results[count - 1], out + n, padded);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "OCR.h"
+#include <cstddef>
+
+// longest record: 9 digits, " XXX" and '\n'
+const size_t maxRecord = 14;
+
+// bytes formatResults may touch for count results, the vector stores run up to 16 bytes ahead
+inline size_t getFormatSize(size_t count) { return count * maxRecord + 16; }
+
+// writes one "<digits>[ STATUS]\n" record per result, as getCheckPlus formats them,
+// and returns the bytes used; with SSE2 where available, one 16 byte Result per vector:
+// the digits of a record are converted in one load, compare and store, but records are
+// still formatted one after the other, since their lengths differ by status
+size_t formatResults(const Result* results, size_t count, char* out);
+// the same with 64 bit word operations, for targets without SSE2
+size_t formatResultsPortable(const Result* results, size_t count, char* out);
+
+// fixed width records, blanks in place of the status of valid accounts: record n starts
+// at n * fixedRecord, so slices can be formatted and written independently
+const size_t fixedRecord = 14;
+
+// writes exactly count * fixedRecord bytes, nothing past them, so workers may format
+// neighbouring slices straight into one shared mapping
+size_t formatFixed(const Result* results, size_t count, char* out);
@@ -0,0 +1,158 @@
+#include "GlyphSet.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+	// stroke bit and byte class of the 9 cell positions, corners are always blank
+	const int strokeBit[9] = { -1, 0, -1, 1, 2, 3, 4, 5, 6 };
+	const ByteClasses::Class strokeClass[9] = {
+		ByteClasses::space, ByteClasses::underscore, ByteClasses::space,
+		ByteClasses::pipe, ByteClasses::underscore, ByteClasses::pipe,
+		ByteClasses::pipe, ByteClasses::underscore, ByteClasses::pipe };
+
+	bool isLabel(const std::string& line) {
+		auto digits = std::count_if(line.begin(), line.end(), [](char c) { return c >= '0' && c <= '9'; });
+		auto spaces = std::count(line.begin(), line.end(), ' ');
+		return digits > 0 && size_t(digits + spaces) == line.size();
+	}
+
+	int countBits(int v) {
+		auto n = 0;
+		for (; v; v &= v - 1) ++n;
+		return n;
+	}
+}
+
+ByteClasses::ByteClasses()
+{
+	std::fill(std::begin(classes), std::end(classes), (unsigned char)other);
+	set(" ", space).set("|", pipe).set("_", underscore);
+}
+
+ByteClasses& ByteClasses::set(const std::string& bytes, Class c)
+{
+	for (auto b : bytes) classes[(unsigned char)b] = c;
+	return *this;
+}
+
+const ByteClasses& ByteClasses::getExact()
+{
+	static const ByteClasses classes;
+	return classes;
+}
+
+const ByteClasses& ByteClasses::getTolerant()
+{
+	static const ByteClasses classes = [] {
+		ByteClasses ret;
+		std::string control(1, '\x7f');
+		for (int b = 0; b < 32; ++b) control += char(b);
+		return ret.set("!lI", pipe).set(control + ".", space);
+	}();
+	return classes;
+}
+
+GlyphSet::GlyphSet(const std::vector<std::pair<int, std::string>>& glyphs)
+{
+	std::fill(std::begin(digits), std::end(digits), -1);
+	for (auto& g : glyphs) {
+		if (g.first < 0 || g.first > 9 || g.second.size() != 9)
+			throw std::invalid_argument("glyph needs a digit and 3x3 characters");
+		auto mask = getMask(g.second.data(), 3);
+		if (mask < 0)
+			throw std::invalid_argument("glyph of " + std::to_string(g.first) + " has no seven segment shape");
+		if (digits[mask] >= 0 && digits[mask] != g.first)
+			throw std::invalid_argument("glyphs of " + std::to_string(digits[mask]) + " and " + std::to_string(g.first) + " collide");
+		if (digits[mask] < 0) variants[g.first].push_back(mask);
+		digits[mask] = (signed char)g.first;
+	}
+
+	for (int d = 0; d < 10; ++d) {
+		for (int r = 0; r < 10; ++r) {
+			if (r == d) continue;
+			for (auto a : variants[d]) {
+				auto near = std::any_of(variants[r].begin(), variants[r].end(), [a](int b) { return countBits(a ^ b) == 1; });
+				if (near) {
+					replacements[d].push_back(r);
+					break;
+				}
+			}
+		}
+	}
+}
+
+GlyphSet& GlyphSet::setReplacements(int digit, const std::vector<int>& digits)
+{
+	if (digit < 0 || digit > 9 || std::any_of(digits.begin(), digits.end(), [](int d) { return d < 0 || d > 9; }))
+		throw std::invalid_argument("replacements need digits");
+	replacements[digit] = digits;
+	return *this;
+}
+
+int GlyphSet::getMask(const char* cell, int width, const ByteClasses& classes)
+{
+	auto mask = 0, bad = 0;
+	for (int p = 0; p < 9; ++p) {
+		auto c = classes.get(cell[p / 3 * width + p % 3]);
+		auto stroke = c == strokeClass[p] && strokeBit[p] >= 0;
+		bad |= c != ByteClasses::space && !stroke;
+		mask |= int(stroke) << (strokeBit[p] & 7);
+	}
+	return bad ? -1 : mask;
+}
+
+void GlyphSet::decodeRows(const char* rows, int width, int* out, const ByteClasses& classes) const
+{
+	// mask bits of the cells accumulate in out, bit 7 flags bytes that are no stroke
+	const int cells = width / 3;
+	std::fill(out, out + cells, 0);
+	for (int r = 0; r < 3; ++r) {
+		const char* row = rows + r * width;
+		for (int cell = 0, c = 0; cell < cells; ++cell) {
+			for (int p = 3 * r; p < 3 * r + 3; ++p, ++c) {
+				auto cls = classes.get(row[c]);
+				auto stroke = cls == strokeClass[p] && strokeBit[p] >= 0;
+				out[cell] |= int(stroke) << (strokeBit[p] & 7) | int(cls != ByteClasses::space && !stroke) << 7;
+			}
+		}
+	}
+	for (int cell = 0; cell < cells; ++cell) out[cell] = out[cell] & 0x80 ? -1 : digits[out[cell]];
+}
+
+GlyphSet GlyphSet::parse(const std::string& text)
+{
+	std::istringstream in(text);
+	std::vector<std::pair<int, std::string>> glyphs;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.find_first_not_of(' ') == std::string::npos || line[0] == '#') continue;
+		if (!isLabel(line)) throw std::invalid_argument("expected a line of digits: " + line);
+
+		std::string label;
+		for (auto c : line) {
+			if (c != ' ') label += c;
+		}
+		std::string rows[3];
+		for (auto& row : rows) {
+			if (!std::getline(in, row)) throw std::invalid_argument("glyph group needs three lines");
+			if (!row.empty() && row.back() == '\r') row.pop_back();
+			row.resize(std::max(row.size(), 3 * label.size()), ' ');
+		}
+		for (size_t i = 0; i < label.size(); ++i) {
+			glyphs.emplace_back(label[i] - '0', rows[0].substr(3 * i, 3) + rows[1].substr(3 * i, 3) + rows[2].substr(3 * i, 3));
+		}
+	}
+	return GlyphSet(glyphs);
+}
+
+GlyphSet GlyphSet::load(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in) throw std::runtime_error("cannot open " + path);
+	std::ostringstream text;
+	text << in.rdbuf();
+	return parse(text.str());
+}
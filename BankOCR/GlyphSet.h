@@ -0,0 +1,69 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+// maps scanner bytes to the stroke they stand for, bytes of class 'other' make a glyph illegible
+class ByteClasses
+{
+public:
+	enum Class : unsigned char { other, space, pipe, underscore };
+
+	// only ' ', '|' and '_'
+	ByteClasses();
+
+	ByteClasses& set(const std::string& bytes, Class c);
+	Class get(char c) const { return Class(classes[(unsigned char)c]); }
+
+	static const ByteClasses& getExact();
+	// additionally '!', 'l' and 'I' as pipe, '.' and control bytes as space
+	static const ByteClasses& getTolerant();
+
+private:
+	unsigned char classes[256];
+};
+
+// a font compiled into a table over the 7 bit stroke masks, several glyph variants per digit
+//
+// text form: a label line with the digit of each glyph, followed by three lines of
+// ascii art with glyph i in the columns 3i..3i+2; blank and '#' lines between groups
+//
+//   0123456789
+//    _     _  _     _  _  _  _  _
+//   | |  | _| _||_||_ |_   ||_||_|
+//   |_|  ||_  _|  | _||_|  ||_| _|
+class GlyphSet
+{
+public:
+	// (digit, 9 bytes of ascii art), throws std::invalid_argument for malformed or colliding glyphs
+	explicit GlyphSet(const std::vector<std::pair<int, std::string>>& glyphs);
+
+	static GlyphSet parse(const std::string& text);
+	static GlyphSet load(const std::string& path);
+
+	// 3x3 cell with rows 'width' bytes apart => 7 bit stroke mask, -1 if a byte is no stroke
+	// (bit order: top, upper left, middle, upper right, lower left, bottom, lower right)
+	static int getMask(const char* cell, int width, const ByteClasses& classes = ByteClasses::getExact());
+
+	// cell => digit, -1 if illegible
+	int decode(const char* cell, int width, const ByteClasses& classes = ByteClasses::getExact()) const {
+		auto mask = getMask(cell, width, classes);
+		return mask < 0 ? -1 : digits[mask];
+	}
+	int getDigit(int mask) const { return digits[mask]; }
+
+	// decodes all width / 3 cells of three rows 'width' bytes apart in one pass per row
+	void decodeRows(const char* rows, int width, int* out, const ByteClasses& classes = ByteClasses::getExact()) const;
+
+	// stroke masks of the glyphs of a digit
+	const std::vector<int>& getVariants(int digit) const { return variants[digit]; }
+	// digits with a glyph one stroke away from a glyph of digit; symmetric as compiled
+	const std::vector<int>& getReplacements(int digit) const { return replacements[digit]; }
+	// replaces the neighbours of digit, for fonts whose repair table is given (the kata's)
+	GlyphSet& setReplacements(int digit, const std::vector<int>& digits);
+
+private:
+	signed char digits[128];
+	std::vector<int> variants[10];
+	std::vector<int> replacements[10];
+};
@@ -0,0 +1,66 @@
+#include "Hash.h"
+#include <cstring>
+
+namespace {
+	const uint64_t prime1 = 11400714785074694791ull;
+	const uint64_t prime2 = 14029467366897019727ull;
+	const uint64_t prime3 = 1609587929392839161ull;
+	const uint64_t prime4 = 9650029242287828579ull;
+	const uint64_t prime5 = 2870177450012600261ull;
+
+	uint64_t rotl(uint64_t v, int r) { return v << r | v >> (64 - r); }
+
+	uint64_t read64(const unsigned char* p) {
+		uint64_t v;
+		std::memcpy(&v, p, 8);
+		return v;
+	}
+
+	uint32_t read32(const unsigned char* p) {
+		uint32_t v;
+		std::memcpy(&v, p, 4);
+		return v;
+	}
+
+	uint64_t round(uint64_t acc, uint64_t input) {
+		return rotl(acc + input * prime2, 31) * prime1;
+	}
+
+	uint64_t merge(uint64_t acc, uint64_t v) {
+		return (acc ^ round(0, v)) * prime1 + prime4;
+	}
+}
+
+uint64_t getHash(const void* data, size_t size, uint64_t seed)
+{
+	auto p = static_cast<const unsigned char*>(data);
+	auto end = p + size;
+	uint64_t h;
+	if (size >= 32) {
+		// four independent lanes over 32 byte stripes
+		uint64_t v1 = seed + prime1 + prime2, v2 = seed + prime2, v3 = seed, v4 = seed - prime1;
+		for (; p + 32 <= end; p += 32) {
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+		}
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+	}
+	else h = seed + prime5;
+
+	h += size;
+	for (; p + 8 <= end; p += 8) h = rotl(h ^ round(0, read64(p)), 27) * prime1 + prime4;
+	if (p + 4 <= end) {
+		h = rotl(h ^ read32(p) * prime1, 23) * prime2 + prime3;
+		p += 4;
+	}
+	for (; p < end; ++p) h = rotl(h ^ *p * prime5, 11) * prime1;
+
+	h ^= h >> 33;
+	h *= prime2;
+	h ^= h >> 29;
+	h *= prime3;
+	return h ^ h >> 32;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// XXH64, a fast non cryptographic hash for content identity
+uint64_t getHash(const void* data, size_t size, uint64_t seed = 0);
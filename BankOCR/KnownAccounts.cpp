@@ -0,0 +1,116 @@
+#include "KnownAccounts.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+	const char plainMagic[8] = { 'B', 'K', 'O', 'C', 'R', 'B', 'I', 'T' };
+	const char compressedMagic[8] = { 'B', 'K', 'O', 'C', 'R', 'R', 'R', '1' };
+	const size_t headerSize = 16;
+
+	const uint32_t chunkCount = (KnownAccounts::maxAccount >> 16) + 1;
+	// a chunk with more accounts than this is stored as 2^16 bit bitmap
+	const uint32_t arrayLimit = 4096;
+	const uint32_t bitmapWords = 65536 / 16;
+
+	// directory entry: offset of the chunk in 16 bit words, number of accounts
+	const size_t directorySize = chunkCount * 2 * sizeof(uint32_t);
+}
+
+const uint32_t KnownAccounts::maxAccount;
+
+KnownAccounts::KnownAccounts(const std::string& path)
+	: file(path)
+{
+	auto data = file.data();
+	if (file.size() < headerSize) throw std::runtime_error("not a known accounts file: " + path);
+	if (0 == std::memcmp(data, plainMagic, 8)) {
+		if (file.size() < headerSize + maxAccount / 8) throw std::runtime_error("truncated known accounts file: " + path);
+		bits = reinterpret_cast<const unsigned char*>(data + headerSize);
+	}
+	else if (0 == std::memcmp(data, compressedMagic, 8)) {
+		if (file.size() < headerSize + directorySize) throw std::runtime_error("truncated known accounts file: " + path);
+		directory = reinterpret_cast<const uint32_t*>(data + headerSize);
+		chunks = reinterpret_cast<const uint16_t*>(data + headerSize + directorySize);
+		// every chunk has to lie within the file, lookups trust the directory
+		const uint64_t words = (file.size() - headerSize - directorySize) / sizeof(uint16_t);
+		for (uint32_t c = 0; c < chunkCount; ++c) {
+			uint64_t offset = directory[2 * c], count = directory[2 * c + 1];
+			if (count == 0) continue;
+			auto size = count > arrayLimit ? bitmapWords : count;
+			if (count > 65536 || offset + size > words) throw std::runtime_error("corrupt known accounts file: " + path);
+		}
+	}
+	else throw std::runtime_error("not a known accounts file: " + path);
+}
+
+bool KnownAccounts::containsChunk(uint32_t account) const
+{
+	auto entry = directory + 2 * (account >> 16);
+	auto count = entry[1];
+	if (count == 0) return false;
+	auto chunk = chunks + entry[0];
+	uint16_t low = account & 0xffff;
+	if (count > arrayLimit) return (chunk[low >> 4] >> (low & 15)) & 1;
+	return std::binary_search(chunk, chunk + count, low);
+}
+
+uint64_t KnownAccounts::getContentHash() const
+{
+	return getHash(file.data(), file.size());
+}
+
+bool KnownAccounts::contains(const std::vector<int>& digits) const
+{
+	uint32_t account = 0;
+	for (auto d : digits) {
+		if (d < 0 || d > 9) return false;
+		account = account * 10 + d;
+	}
+	return digits.size() == 9 && contains(account);
+}
+
+void writeKnownAccounts(const std::string& path, std::vector<uint32_t> accounts, bool compressed)
+{
+	std::sort(accounts.begin(), accounts.end());
+	accounts.erase(std::unique(accounts.begin(), accounts.end()), accounts.end());
+	accounts.erase(std::lower_bound(accounts.begin(), accounts.end(), KnownAccounts::maxAccount), accounts.end());
+
+	std::ofstream out(path, std::ios::binary);
+	if (!out) throw std::runtime_error("cannot write " + path);
+	char header[headerSize] = {};
+	std::memcpy(header, compressed ? compressedMagic : plainMagic, 8);
+	uint64_t count = accounts.size();
+	std::memcpy(header + 8, &count, 8);
+	out.write(header, headerSize);
+
+	if (!compressed) {
+		std::vector<unsigned char> bits(KnownAccounts::maxAccount / 8);
+		for (auto a : accounts) bits[a >> 3] |= 1 << (a & 7);
+		out.write(reinterpret_cast<const char*>(bits.data()), bits.size());
+	}
+	else {
+		std::vector<uint32_t> directory(2 * chunkCount);
+		std::vector<uint16_t> data;
+		for (auto it = accounts.begin(); it != accounts.end();) {
+			auto hi = *it >> 16;
+			auto end = std::find_if(it, accounts.end(), [hi](uint32_t a) { return (a >> 16) != hi; });
+			auto n = uint32_t(end - it);
+			directory[2 * hi] = uint32_t(data.size());
+			directory[2 * hi + 1] = n;
+			if (n > arrayLimit) {
+				auto base = data.size();
+				data.resize(base + bitmapWords);
+				for (; it != end; ++it) data[base + ((*it & 0xffff) >> 4)] |= 1 << (*it & 15);
+			}
+			else {
+				for (; it != end; ++it) data.push_back(uint16_t(*it & 0xffff));
+			}
+		}
+		out.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(uint32_t));
+		out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(uint16_t));
+	}
+	if (!out) throw std::runtime_error("cannot write " + path);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// memory mapped set of the open 9 digit accounts, either a plain 10^9 bit bitset
+// or a roaring style file of 2^16 account chunks stored as sorted arrays or bitmaps
+class KnownAccounts
+{
+public:
+	static const uint32_t maxAccount = 1000000000;
+
+	explicit KnownAccounts(const std::string& path);
+
+	bool contains(uint32_t account) const {
+		if (account >= maxAccount) return false;
+		return bits ? (bits[account >> 3] >> (account & 7)) & 1 : containsChunk(account);
+	}
+	bool contains(const std::vector<int>& digits) const;
+
+	bool isCompressed() const { return !bits; }
+	// XXH64 of the file, identifies the set
+	uint64_t getContentHash() const;
+
+private:
+	bool containsChunk(uint32_t account) const;
+
+	MappedFile file;
+	const unsigned char* bits = nullptr;
+	const uint32_t* directory = nullptr;
+	const uint16_t* chunks = nullptr;
+};
+
+// writes the accounts in the format read by KnownAccounts
+void writeKnownAccounts(const std::string& path, std::vector<uint32_t> accounts, bool compressed);
@@ -0,0 +1,154 @@
+#include "Latency.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define BANKOCR_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BANKOCR_RDTSC
+#endif
+
+namespace {
+	const int subBits = 4;
+	const int subBuckets = 1 << subBits;
+
+	// v > 0
+	int getHighBit(uint64_t v) {
+#if defined(_MSC_VER) && defined(_M_X64)
+		unsigned long n;
+		_BitScanReverse64(&n, v);
+		return int(n);
+#elif defined(__GNUC__)
+		return 63 - __builtin_clzll(v);
+#else
+		auto n = 0;
+		while (v >>= 1) ++n;
+		return n;
+#endif
+	}
+
+	// "312ns", "1.2us", "4.5ms"
+	std::string getDuration(double seconds) {
+		static const char* const units[] = { "ns", "us", "ms", "s" };
+		auto value = seconds * 1e9;
+		auto unit = 0;
+		for (; value >= 1000 && unit < 3; ++unit) value /= 1000;
+		char text[32];
+		std::snprintf(text, sizeof(text), value < 10 ? "%.1f%s" : "%.0f%s", value, units[unit]);
+		return text;
+	}
+}
+
+uint64_t getTicks()
+{
+#ifdef BANKOCR_RDTSC
+	return __rdtsc();
+#else
+	return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+double getTicksPerSecond()
+{
+	static const double ticks = [] {
+#ifdef BANKOCR_RDTSC
+		// spins 20 ms, the counter runs at a constant rate on current processors
+		auto start = std::chrono::steady_clock::now();
+		auto first = getTicks();
+		std::chrono::duration<double> took;
+		do took = std::chrono::steady_clock::now() - start; while (took.count() < 0.02);
+		return double(getTicks() - first) / took.count();
+#else
+		return double(std::chrono::steady_clock::period::den) / std::chrono::steady_clock::period::num;
+#endif
+	}();
+	return ticks;
+}
+
+int LatencyHistogram::getBucket(uint64_t value)
+{
+	if (value < subBuckets) return int(value);
+	auto high = getHighBit(value);
+	return (high - subBits + 1) * subBuckets + int(value >> (high - subBits)) - subBuckets;
+}
+
+uint64_t LatencyHistogram::getUpperBound(int bucket)
+{
+	if (bucket < subBuckets) return uint64_t(bucket);
+	auto shift = bucket / subBuckets - 1;
+	auto low = uint64_t(subBuckets + bucket % subBuckets) << shift;
+	return low + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+	for (int b = 0; b < buckets; ++b) {
+		auto n = other.getCount(b);
+		if (n) counts[b].fetch_add(n, std::memory_order_relaxed);
+	}
+}
+
+void LatencyHistogram::clear()
+{
+	for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+	uint64_t ret = 0;
+	for (int b = 0; b < buckets; ++b) ret += getCount(b);
+	return ret;
+}
+
+uint64_t LatencyHistogram::getPercentile(double p) const
+{
+	auto total = getCount();
+	if (!total) return 0;
+	auto rank = uint64_t(std::ceil(p * double(total)));
+	if (rank < 1) rank = 1;
+	uint64_t seen = 0;
+	auto last = 0;
+	for (int b = 0; b < buckets; ++b) {
+		auto n = getCount(b);
+		if (!n) continue;
+		seen += n;
+		last = b;
+		if (seen >= rank) break;
+	}
+	return getUpperBound(last);
+}
+
+const char* getStageName(Stage stage)
+{
+	static const char* const names[] = { "frame", "read", "validate", "repair", "output" };
+	return names[int(stage)];
+}
+
+void StageLatency::merge(const StageLatency& other)
+{
+	for (int s = 0; s < int(Stage::count); ++s) stages[s].merge(other.stages[s]);
+}
+
+std::string StageLatency::toString() const
+{
+	const auto perTick = 1 / getTicksPerSecond();
+	std::ostringstream out;
+	for (int s = 0; s < int(Stage::count); ++s) {
+		auto& h = stages[s];
+		out << getStageName(Stage(s)) << " count " << h.getCount();
+		if (h.getCount()) {
+			out << " p50 " << getDuration(h.getPercentile(0.5) * perTick)
+				<< " p99 " << getDuration(h.getPercentile(0.99) * perTick)
+				<< " p99.9 " << getDuration(h.getPercentile(0.999) * perTick)
+				<< " max " << getDuration(h.getPercentile(1) * perTick);
+		}
+		out << '\n';
+	}
+	return out.str();
+}
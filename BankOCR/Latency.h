@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// time stamp counter where the target has one (rdtsc), steady_clock ticks otherwise
+uint64_t getTicks();
+// ticks of getTicks per second, calibrated against steady_clock on the first call
+double getTicksPerSecond();
+
+// log bucketed histogram: values below 16 exact, above in 16 buckets per power of two,
+// so a percentile is within 1/16 of the recorded values
+//
+// one thread records, any thread may read or merge it at the same time without locks;
+// the counts are relaxed atomics, so a reader sees each count whole, if not all of them
+class LatencyHistogram
+{
+public:
+	static const int buckets = 61 * 16;
+
+	LatencyHistogram() { clear(); }
+
+	void record(uint64_t value) {
+		auto& c = counts[getBucket(value)];
+		c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	// adds the counts of other, which may be recording meanwhile
+	void merge(const LatencyHistogram& other);
+	void clear();
+
+	uint64_t getCount() const;
+	uint64_t getCount(int bucket) const { return counts[bucket].load(std::memory_order_relaxed); }
+	// highest value of the bucket holding the p-th fraction of the values, 0 if empty
+	uint64_t getPercentile(double p) const;
+
+	static int getBucket(uint64_t value);
+	static uint64_t getUpperBound(int bucket);
+
+private:
+	std::atomic<uint64_t> counts[buckets];
+};
+
+// the stages of decoding an entry; repair only for the entries that fail validation
+enum class Stage { frame, read, validate, repair, output, count };
+
+// "frame", "read", "validate", "repair" or "output"
+const char* getStageName(Stage stage);
+
+// a histogram of getTicks durations per stage
+struct StageLatency
+{
+	LatencyHistogram stages[int(Stage::count)];
+
+	LatencyHistogram& operator[](Stage stage) { return stages[int(stage)]; }
+	const LatencyHistogram& operator[](Stage stage) const { return stages[int(stage)]; }
+
+	void merge(const StageLatency& other);
+
+	// one line per stage: "read count n p50 312ns p99 1.2us p99.9 4.5us max 20us"
+	std::string toString() const;
+};
@@ -0,0 +1,86 @@
+#include "MappedFile.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path)
+{
+	auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot open " + path);
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	len = size_t(size.QuadPart);
+	if (len) {
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping) ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	CloseHandle(file);
+	if (len && !ptr) {
+		close();
+		throw std::runtime_error("cannot map " + path);
+	}
+}
+
+void MappedFile::close()
+{
+	if (ptr) UnmapViewOfFile(ptr);
+	if (mapping) CloseHandle(mapping);
+	ptr = nullptr;
+	mapping = nullptr;
+	len = 0;
+}
+#else
+MappedFile::MappedFile(const std::string& path)
+{
+	auto fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("cannot open " + path);
+	struct stat st;
+	if (fstat(fd, &st) == 0) len = size_t(st.st_size);
+	if (len) {
+		auto p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED) ptr = static_cast<const char*>(p);
+	}
+	::close(fd);
+	if (len && !ptr) throw std::runtime_error("cannot map " + path);
+}
+
+void MappedFile::close()
+{
+	if (ptr) munmap(const_cast<char*>(ptr), len);
+	ptr = nullptr;
+	len = 0;
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+	if (this != &other) {
+		close();
+		std::swap(ptr, other.ptr);
+		std::swap(len, other.len);
+#ifdef _WIN32
+		std::swap(mapping, other.mapping);
+#endif
+	}
+	return *this;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// read only memory mapping of a whole file, shared between all processes mapping it
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(MappedFile&& other);
+	MappedFile& operator=(MappedFile&& other);
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* data() const { return ptr; }
+	size_t size() const { return len; }
+
+private:
+	void close();
+
+	const char* ptr = nullptr;
+	size_t len = 0;
+#ifdef _WIN32
+	void* mapping = nullptr;
+#endif
+};
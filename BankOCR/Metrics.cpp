@@ -0,0 +1,193 @@
+#include "Metrics.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+	const char* const statusNames[] = { "ok", "err", "ill", "amb", "fix", "unk" };
+	// histogram bounds in seconds
+	const double bounds[] = { 1e-7, 2.5e-7, 5e-7, 1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3, 1e-2, 1e-1, 1 };
+
+	uint64_t load(const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); }
+
+	void putCounter(std::ostream& out, const char* name, const char* help, uint64_t value) {
+		out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " counter\n" << name << ' ' << value << '\n';
+	}
+}
+
+WorkerCounters::WorkerCounters()
+{
+	for (auto* c : { &entries, &bytes, &decoded, &cacheHits, &checkpoints }) c->store(0);
+	for (auto& c : status) c.store(0);
+}
+
+Metrics::Metrics(int workers)
+{
+	for (int w = 0; w < workers; ++w) {
+		counters.emplace_back(new WorkerCounters());
+		latency.emplace_back(new StageLatency());
+	}
+}
+
+std::string Metrics::toPrometheus() const
+{
+	uint64_t entries = 0, bytes = 0, decoded = 0, cacheHits = 0, checkpoints = 0, status[6] = {};
+	StageLatency stages;
+	for (size_t w = 0; w < counters.size(); ++w) {
+		auto& c = *counters[w];
+		entries += load(c.entries);
+		bytes += load(c.bytes);
+		decoded += load(c.decoded);
+		cacheHits += load(c.cacheHits);
+		checkpoints += load(c.checkpoints);
+		for (int s = 0; s < 6; ++s) status[s] += load(c.status[s]);
+		stages.merge(*latency[w]);
+	}
+
+	std::ostringstream out;
+	putCounter(out, "bankocr_entries_total", "Entries processed.", entries);
+	putCounter(out, "bankocr_input_bytes_total", "Input bytes framed into entries.", bytes);
+	putCounter(out, "bankocr_decoded_total", "Entries decoded, not taken from the cache.", decoded);
+	putCounter(out, "bankocr_cache_hits_total", "Entries whose results were taken from the cache.", cacheHits);
+	putCounter(out, "bankocr_checkpoints_total", "Journal checkpoints committed.", checkpoints);
+	out << "# HELP bankocr_status_total Entries by reported status.\n# TYPE bankocr_status_total counter\n";
+	for (int s = 0; s < 6; ++s) out << "bankocr_status_total{status=\"" << statusNames[s] << "\"} " << status[s] << '\n';
+
+	const auto perTick = 1 / getTicksPerSecond();
+	// the counts cover the timed entries only and the sum the bucket bounds, not the times
+	out << "# HELP bankocr_stage_seconds Time per stage of one entry in BatchOptions::latencySample (8 by default), output per chunk;"
+		" count is of the timed entries, sum adds their bucket upper bounds.\n# TYPE bankocr_stage_seconds histogram\n";
+	for (int s = 0; s < int(Stage::count); ++s) {
+		auto& h = stages.stages[s];
+		auto name = getStageName(Stage(s));
+		uint64_t count = 0;
+		double sum = 0;
+		size_t bound = 0;
+		for (int b = 0; b < LatencyHistogram::buckets; ++b) {
+			auto seconds = double(LatencyHistogram::getUpperBound(b)) * perTick;
+			for (; bound < sizeof(bounds) / sizeof(bounds[0]) && seconds > bounds[bound]; ++bound) {
+				out << "bankocr_stage_seconds_bucket{stage=\"" << name << "\",le=\"" << bounds[bound] << "\"} " << count << '\n';
+			}
+			auto n = h.getCount(b);
+			count += n;
+			sum += double(n) * seconds;
+		}
+		for (; bound < sizeof(bounds) / sizeof(bounds[0]); ++bound) {
+			out << "bankocr_stage_seconds_bucket{stage=\"" << name << "\",le=\"" << bounds[bound] << "\"} " << count << '\n';
+		}
+		out << "bankocr_stage_seconds_bucket{stage=\"" << name << "\",le=\"+Inf\"} " << count << '\n';
+		out << "bankocr_stage_seconds_sum{stage=\"" << name << "\"} " << sum << '\n';
+		out << "bankocr_stage_seconds_count{stage=\"" << name << "\"} " << count << '\n';
+	}
+	return out.str();
+}
+
+void writeMetricsFile(const std::string& path, const Metrics& metrics)
+{
+	auto temp = path + ".tmp";
+	{
+		std::ofstream out(temp, std::ios::binary);
+		if (!(out << metrics.toPrometheus())) throw std::runtime_error("cannot write " + temp);
+	}
+#ifdef _WIN32
+	auto ok = MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	auto ok = std::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+	if (!ok) throw std::runtime_error("cannot replace " + path);
+}
+
+MetricsFileWriter::MetricsFileWriter(const std::string& path, const Metrics& metrics, std::chrono::milliseconds interval)
+	: path(path), metrics(metrics), done(false)
+{
+	thread = std::thread([this, interval] {
+		const auto step = std::chrono::milliseconds(10);
+		while (!done) {
+			for (auto waited = std::chrono::milliseconds(0); waited < interval && !done; waited += step) std::this_thread::sleep_for(step);
+			// a failed write is retried with the next interval
+			try {
+				writeMetricsFile(this->path, this->metrics);
+			}
+			catch (const std::runtime_error&) {}
+		}
+	});
+}
+
+MetricsFileWriter::~MetricsFileWriter()
+{
+	done = true;
+	thread.join();
+}
+
+#ifdef _WIN32
+MetricsServer::MetricsServer(const std::string& socketPath, const Metrics& metrics)
+	: path(socketPath), metrics(metrics), done(true)
+{
+	throw std::runtime_error("metrics sockets need a POSIX system");
+}
+
+MetricsServer::~MetricsServer()
+{
+}
+#else
+MetricsServer::MetricsServer(const std::string& socketPath, const Metrics& metrics)
+	: path(socketPath), metrics(metrics), done(false)
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("socket path too long: " + path);
+	std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) throw std::runtime_error("cannot create socket " + path);
+	::unlink(path.c_str());
+	if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 8) != 0) {
+		::close(listener);
+		throw std::runtime_error("cannot listen on " + path);
+	}
+
+	thread = std::thread([this] {
+		pollfd wait = { listener, POLLIN, 0 };
+		while (!done) {
+			// wakes up now and then to notice the destructor
+			if (poll(&wait, 1, 50) <= 0) continue;
+			auto client = accept(listener, nullptr, nullptr);
+			if (client < 0) continue;
+			// the request itself does not matter, every path gets the metrics
+			char request[1024];
+			pollfd readable = { client, POLLIN, 0 };
+			if (poll(&readable, 1, 100) > 0) (void)::recv(client, request, sizeof(request), 0);
+			auto body = this->metrics.toPrometheus();
+			auto response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+				+ std::to_string(body.size()) + "\r\n\r\n" + body;
+			for (size_t sent = 0; sent < response.size();) {
+				auto n = ::send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+				if (n <= 0) break;
+				sent += size_t(n);
+			}
+			::close(client);
+		}
+	});
+}
+
+MetricsServer::~MetricsServer()
+{
+	done = true;
+	thread.join();
+	::close(listener);
+	::unlink(path.c_str());
+}
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+#include "Latency.h"
+#include "OCR.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// counters of one worker, written by that worker only; the padding keeps the counters
+// of neighbouring workers on different cache lines
+struct WorkerCounters
+{
+	char before[64];
+	std::atomic<uint64_t> entries;
+	std::atomic<uint64_t> bytes;
+	std::atomic<uint64_t> status[6];
+	std::atomic<uint64_t> decoded;
+	std::atomic<uint64_t> cacheHits;
+	std::atomic<uint64_t> checkpoints;
+	char after[64];
+
+	WorkerCounters();
+
+	// single writer, so a relaxed load and store instead of a locked add
+	static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+		counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	}
+};
+
+// the counters and stage histograms of all workers of the engine, summed when scraped
+class Metrics
+{
+public:
+	explicit Metrics(int workers = 1);
+
+	int getWorkers() const { return int(counters.size()); }
+	WorkerCounters& getCounters(int worker) { return *counters[worker]; }
+	StageLatency& getLatency(int worker) { return *latency[worker]; }
+
+	// Prometheus text exposition format 0.0.4, counters and a histogram per stage; the
+	// histograms hold what was recorded, a sample of the entries in runBatch
+	std::string toPrometheus() const;
+
+private:
+	std::vector<std::unique_ptr<WorkerCounters>> counters;
+	std::vector<std::unique_ptr<StageLatency>> latency;
+};
+
+// replaces path by the current metrics: written to path.tmp, then renamed over it
+void writeMetricsFile(const std::string& path, const Metrics& metrics);
+
+// rewrites a metrics file every interval until destroyed, and once more then
+class MetricsFileWriter
+{
+public:
+	MetricsFileWriter(const std::string& path, const Metrics& metrics, std::chrono::milliseconds interval);
+	~MetricsFileWriter();
+
+private:
+	std::string path;
+	const Metrics& metrics;
+	std::atomic<bool> done;
+	std::thread thread;
+};
+
+// answers every connection on a local Unix socket with an HTTP response holding the
+// metrics, until destroyed; throws std::runtime_error if the socket cannot be bound
+// (or on Windows, which this does not support)
+class MetricsServer
+{
+public:
+	MetricsServer(const std::string& socketPath, const Metrics& metrics);
+	~MetricsServer();
+
+private:
+	std::string path;
+	const Metrics& metrics;
+	int listener = -1;
+	std::atomic<bool> done;
+	std::thread thread;
+};
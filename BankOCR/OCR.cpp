@@ -1,124 +1,204 @@
 #include "OCR.h"
+#include "Confusion.h"
+#include "KnownAccounts.h"
+#include <algorithm>
 #include <cassert>
-
-
-std::vector<int> OCR::read(const std::string& input)
-{
-	assert(4 * 27 == input.size());
-	std::vector<int> result;
-	for (int i = 0; i < 9; ++i) {
-		std::string sign = getPos(input, i);
-		result.push_back( getNumber(sign) );
-	}
-	return result;
-}
-
-namespace {
-	std::string charArray[10] = {
-		" _ "
-		"| |"
-		"|_|",
-		"   "
-		"  |"
-		"  |",
-		" _ "
-		" _|"
-		"|_ ",
-		" _ "
-		" _|"
-		" _|",
-		"   "
-		"|_|"
-		"  |",
-		" _ "
-		"|_ "
-		" _|",
-		" _ "
-		"|_ "
-		"|_|",
-		" _ "
-		"  |"
-		"  |",
-		" _ "
-		"|_|"
-		"|_|",
-		" _ "
-		"|_|"
-		" _|" };
-}
-
-std::string OCR::getPos(const std::string& input, int i) {
-	return 
-		input.substr(i * 3, 3)
-		+ input.substr(27 + i* 3, 3) 
-		+ input.substr(2*27 + i * 3, 3);
-}
-
-int OCR::getNumber(const std::string& str) {
-	auto i = 0;
-	for (auto ch : charArray) {
-		if (ch == str) return i;
-		i++;
-	}
-	return -1;
-}
-
+#include <utility>
+
+const char* const KataFont::glyphs[10] = {
+	" _ "
+	"| |"
+	"|_|",
+	"   "
+	"  |"
+	"  |",
+	" _ "
+	" _|"
+	"|_ ",
+	" _ "
+	" _|"
+	" _|",
+	"   "
+	"|_|"
+	"  |",
+	" _ "
+	"|_ "
+	" _|",
+	" _ "
+	"|_ "
+	"|_|",
+	" _ "
+	"  |"
+	"  |",
+	" _ "
+	"|_|"
+	"|_|",
+	" _ "
+	"|_|"
+	" _|" };
+
+const std::vector<int> KataFont::replacements[10] = { { 8 },{ 7 },{},{ 9 },{},{ 6,9 },{},{ 1 },{ 0,6,9 },{ 3,5,8 } };
 
 int getCheckSum(const std::vector<int>& in) {
-	auto ret = 0, p = 0;
-	for (auto v : in) ret += (9 - p++) * v;
-	return ret % 11;
+	return OCR::getCheckSum(in);
 }
 
 std::string getCheck(const std::vector<int>& in)
 {
-	std::string ret = "";
-	for (int i : in) ret += i < 0 ? '?' : '0'+i;
-
-	for (auto n : in) {
-		if (n < 0) return ret + " ILL";
-	}
-	return ret + (getCheckSum(in) ? " ERR" : "");
+	return OCR::getCheck(in);
 }
 
-std::vector<std::vector<int>> replacements = { { 8 },{ 7 },{},{ 9 },{},{ 6,9 },{},{ 1 },{ 0,6,9 },{ 3,5,8 } };
-
 std::vector<std::vector<int>> checkReplace(std::vector<int> in)
+{
+	return OCR::checkReplace(std::move(in));
+}
+
+std::vector<std::vector<int>> checkReplace(std::vector<int> in, const ChecksumScheme& scheme)
 {
 	std::vector<std::vector<int>> results;
-	for (auto &i : in) {
-		int org = i;
-		for (auto r : replacements[i])
-		{
-			i = r;
-			if (getCheckSum(in) == 0 ) {
-				results.push_back( in );
+	results.reserve(2);
+	const auto sum = scheme.getSum(in);
+	for (int pos = 0; pos < int(in.size()); ++pos) {
+		int org = in[pos];
+		for (auto r : OCR::getGlyphSet().getReplacements(org)) {
+			if (scheme.getResidue(sum + scheme.getDelta(pos, org, r)) == 0) {
+				in[pos] = r;
+				results.push_back(in);
+				in[pos] = org;
 				if (results.size() > 1) {
 					return results;
 				}
-			};
+			}
 		}
-		i = org;
 	}
 	return results;
 }
 
 std::string getCheckPlus(const std::vector<int>& in)
 {
-	std::string ret = "";
-	for (int i : in) ret += i < 0 ? '?' : '0' + i;
+	return OCR::getCheckPlus(in);
+}
+
+namespace {
+	const ChecksumScheme& getScheme(const RepairOptions& options) {
+		return options.checksum ? *options.checksum : ChecksumScheme::getMod11();
+	}
+
+	// calls f(pos, digit) for every one stroke repair of the legible in that passes the
+	// checksum and, with known accounts, is an open account
+	template <class F>
+	void forEachRepair(const std::vector<int>& in, const RepairOptions& options, int sum, F f)
+	{
+		const auto& scheme = getScheme(options);
+		// copied only to look up known accounts
+		std::vector<int> digits;
+		if (options.known) digits = in;
+		for (int pos = 0; pos < int(in.size()); ++pos) {
+			const auto& glyphs = options.glyphs ? *options.glyphs : OCR::getGlyphSet();
+			const auto& replacements = glyphs.getReplacements(in[pos]);
+			for (auto r : replacements) {
+				if (scheme.getResidue(sum + scheme.getDelta(pos, in[pos], r)) != 0) continue;
+				if (options.known) {
+					digits[pos] = r;
+					bool exists = options.known->contains(digits);
+					digits[pos] = in[pos];
+					if (!exists) continue;
+				}
+				f(pos, r);
+			}
+		}
+	}
+
+	// status of in after validate, for FIX the repair in fixPos and fixDigit
+	Status getStatus(const std::vector<int>& in, const RepairOptions& options, Status validated, int& fixPos, int& fixDigit)
+	{
+		if (validated != Status::err) return validated;
+		const auto* model = options.model;
+		const auto sum = getScheme(options).getSum(in);
+
+		// keep the two cheapest candidates while searching the residual
+		auto count = 0, bestPos = -1, bestDigit = -1;
+		auto best = ConfusionModel::maxCost, second = ConfusionModel::maxCost;
+		forEachRepair(in, options, sum, [&](int pos, int r) {
+			++count;
+			auto cost = model ? model->getRepairCost(in[pos], r) : 0;
+			if (cost < best) {
+				second = best;
+				best = cost; bestPos = pos; bestDigit = r;
+			}
+			else if (cost < second) {
+				second = cost;
+			}
+		});
+
+		if (count == 0) return Status::err;
+		if (count > 1 && (!model || second - best < model->getMargin())) return Status::amb;
+
+		fixPos = bestPos;
+		fixDigit = bestDigit;
+		return Status::fix;
+	}
+
+	Status getStatus(const std::vector<int>& in, const RepairOptions& options, int& fixPos, int& fixDigit)
+	{
+		return getStatus(in, options, validate(in, options), fixPos, fixDigit);
+	}
+}
 
+Status validate(const std::vector<int>& in, const RepairOptions& options)
+{
 	for (auto n : in) {
-		if (n < 0) return ret + " ILL";
+		if (n < 0) return Status::ill;
 	}
-	if (0 == getCheckSum(in)) return ret;
-	auto v = checkReplace(in);
+	const auto& scheme = getScheme(options);
+	if (0 != scheme.getResidue(scheme.getSum(in))) return Status::err;
+	return !options.known || options.known->contains(in) ? Status::ok : Status::unk;
+}
 
-	if (v.empty()) return ret + " ERR";
-	if (v.size() != 1) return ret + " AMB";
+const char* getStatusText(Status status)
+{
+	static const char* const texts[] = { "", " ERR", " ILL", " AMB", " FIX", " UNK" };
+	return texts[int(status)];
+}
 
-	ret = "";
-	for (int i : v[0]) ret += '0' + i;
-	return ret + " FIX";
+std::string getCheckPlus(const std::vector<int>& in, const RepairOptions& options)
+{
+	if (!options.model && !options.known && !options.checksum && !options.glyphs) return getCheckPlus(in);
+	auto fixPos = -1, fixDigit = -1;
+	auto status = getStatus(in, options, fixPos, fixDigit);
+	auto ret = OCR::getDigits(in);
+	if (status == Status::fix) ret[fixPos] = char('0' + fixDigit);
+	return ret + getStatusText(status);
 }
 
+const unsigned char Result::illegible;
+
+Result getResult(const std::vector<int>& in, const RepairOptions& options)
+{
+	return getResult(in, options, validate(in, options));
+}
+
+Result getResult(const std::vector<int>& in, const RepairOptions& options, Status validated)
+{
+	assert(size_t(OCR::digits) == in.size());
+	auto fixPos = -1, fixDigit = -1;
+	Result result = {};
+	result.status = getStatus(in, options, validated, fixPos, fixDigit);
+	for (int i = 0; i < OCR::digits; ++i) result.digits[i] = in[i] < 0 ? Result::illegible : (unsigned char)in[i];
+	if (result.status == Status::fix) result.digits[fixPos] = (unsigned char)fixDigit;
+	return result;
+}
+
+std::vector<std::vector<int>> getCandidates(const std::vector<int>& in, const RepairOptions& options)
+{
+	std::vector<std::vector<int>> results;
+	for (auto n : in) {
+		if (n < 0) return results;
+	}
+	forEachRepair(in, options, getScheme(options).getSum(in), [&](int pos, int r) {
+		results.push_back(in);
+		results.back()[pos] = r;
+	});
+	std::sort(results.begin(), results.end());
+	return results;
+}
@@ -1,21 +1,55 @@
 #pragma once
+#include "BasicOCR.h"
 #include <string>
 #include <vector>
 
-class OCR
+// the kata: 9 digit accounts, 27 columns, weighted mod 11 checksum
+using OCR = BasicOCR<KataFont, 9>;
+
+class ConfusionModel;
+class KnownAccounts;
+
+struct RepairOptions
 {
-public:
-	// multiline string => vector of digits
-	static std::vector<int> read(const std::string& input);
+	// ranks the candidates, an AMB entry is fixed if one candidate dominates
+	const ConfusionModel* model = nullptr;
+	// drops candidates that are no open account, valid unknown accounts get UNK
+	const KnownAccounts* known = nullptr;
+	// validates and repairs with another scheme than the kata's weighted mod 11
+	const ChecksumScheme* checksum = nullptr;
+	// one stroke neighbours of a loaded font instead of the kata's table; a font loaded from
+	// text gets all of them, so with the kata glyphs 6 may become 5 or 8, which the kata
+	// table (and OCR::getGlyphSet) leave out
+	const GlyphSet* glyphs = nullptr;
+};
 
+enum class Status : unsigned char { ok, err, ill, amb, fix, unk };
+
+// "", " ERR", " ILL", " AMB", " FIX" or " UNK"
+const char* getStatusText(Status status);
+
+// outcome of getCheckPlus as packed digits, 16 bytes so batches can be loaded as vectors
+struct Result
+{
+	static const unsigned char illegible = 0xff;
 
-	static std::string getPos(const std::string& input, int i);
-	static int getNumber(const std::string& str);
+	unsigned char digits[9];
+	Status status;
+	unsigned char reserved[6];
 };
 
 int getCheckSum(const std::vector<int>& in);
 
 std::string getCheck(const std::vector<int>& in);
 std::string getCheckPlus(const std::vector<int>& in);
+std::string getCheckPlus(const std::vector<int>& in, const RepairOptions& options);
+Result getResult(const std::vector<int>& in, const RepairOptions& options = RepairOptions());
+// the checksum step of getResult on its own: ILL, OK or UNK, ERR where a repair is due
+Status validate(const std::vector<int>& in, const RepairOptions& options = RepairOptions());
+// getResult of in that validate found validated, so the repair runs for ERR only
+Result getResult(const std::vector<int>& in, const RepairOptions& options, Status validated);
+// all repairs one stroke away that pass the checksum (and are known accounts), ascending
+std::vector<std::vector<int>> getCandidates(const std::vector<int>& in, const RepairOptions& options = RepairOptions());
 
-std::vector<std::vector<int>> checkReplace(std::vector<int> in);
\ No newline at end of file
+std::vector<std::vector<int>> checkReplace(std::vector<int> in);
+std::vector<std::vector<int>> checkReplace(std::vector<int> in, const ChecksumScheme& scheme);
\ No newline at end of file
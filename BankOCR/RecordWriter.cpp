@@ -0,0 +1,115 @@
+#include "RecordWriter.h"
+#include "ResultColumns.h"
+#include <cstring>
+#include <ostream>
+
+namespace {
+	const char* const statusNames[] = { "OK", "ERR", "ILL", "AMB", "FIX", "UNK" };
+	// longest record without candidates, and per candidate
+	const size_t recordSize = 96;
+	const size_t candidateSize = 12;
+}
+
+RecordWriter::RecordWriter(std::ostream& out, size_t bufferSize)
+	: out(out), buffer(bufferSize)
+{
+}
+
+RecordWriter::~RecordWriter()
+{
+	flush();
+}
+
+void RecordWriter::flush()
+{
+	out.write(buffer.data(), std::streamsize(used));
+	used = 0;
+}
+
+char* RecordWriter::reserve(size_t size)
+{
+	if (buffer.size() - used < size) {
+		flush();
+		if (buffer.size() < size) buffer.resize(size);
+	}
+	return buffer.data() + used;
+}
+
+void RecordWriter::write(const ResultColumns& columns, size_t i)
+{
+	write(columns.getResult(i), columns.getOffset(i), columns.getCandidates(i), columns.getCandidateCount(i));
+}
+
+char* RecordWriter::putDigits(char* out, const Result& result)
+{
+	for (int p = 0; p < 9; ++p) out[p] = result.digits[p] == Result::illegible ? '?' : char('0' + result.digits[p]);
+	return out + 9;
+}
+
+char* RecordWriter::putAccount(char* out, uint32_t account)
+{
+	for (int p = 8; p >= 0; --p, account /= 10) out[p] = char('0' + account % 10);
+	return out + 9;
+}
+
+char* RecordWriter::putNumber(char* out, uint64_t value)
+{
+	char digits[20];
+	auto n = 0;
+	do {
+		digits[n++] = char('0' + value % 10);
+		value /= 10;
+	} while (value);
+	while (n) *out++ = digits[--n];
+	return out;
+}
+
+char* RecordWriter::putText(char* out, const char* text)
+{
+	auto n = std::strlen(text);
+	std::memcpy(out, text, n);
+	return out + n;
+}
+
+void JsonLinesWriter::write(const Result& result, uint64_t offset, const uint32_t* candidates, size_t count)
+{
+	auto out = reserve(recordSize + candidateSize * count);
+	out = putText(out, "{\"offset\":");
+	out = offset == ResultColumns::noOffset ? putText(out, "null") : putNumber(out, offset);
+	out = putText(out, ",\"account\":\"");
+	out = putDigits(out, result);
+	out = putText(out, "\",\"status\":\"");
+	out = putText(out, statusNames[int(result.status)]);
+	out = putText(out, "\",\"candidates\":[");
+	for (size_t c = 0; c < count; ++c) {
+		if (c) *out++ = ',';
+		*out++ = '"';
+		out = putAccount(out, candidates[c]);
+		*out++ = '"';
+	}
+	out = putText(out, "]}\n");
+	commit(out);
+}
+
+CsvWriter::CsvWriter(std::ostream& out, size_t bufferSize)
+	: RecordWriter(out, bufferSize)
+{
+	commit(putText(reserve(recordSize), "offset,account,status,candidates\n"));
+}
+
+void CsvWriter::write(const Result& result, uint64_t offset, const uint32_t* candidates, size_t count)
+{
+	auto out = reserve(recordSize + candidateSize * count);
+	if (offset != ResultColumns::noOffset) out = putNumber(out, offset);
+	*out++ = ',';
+	out = putDigits(out, result);
+	*out++ = ',';
+	out = putText(out, statusNames[int(result.status)]);
+	*out++ = ',';
+	for (size_t c = 0; c < count; ++c) {
+		if (c) *out++ = ';';
+		out = putAccount(out, candidates[c]);
+	}
+	*out++ = '\n';
+	commit(out);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "OCR.h"
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+class ResultColumns;
+
+// streams structured result records (offset, digits, status, candidates) into out,
+// serialised straight into a reusable buffer that is flushed when full
+class RecordWriter
+{
+public:
+	virtual ~RecordWriter();
+
+	// offset ResultColumns::noOffset if unknown, candidates of AMB entries as 9 digit numbers
+	virtual void write(const Result& result, uint64_t offset, const uint32_t* candidates = nullptr, size_t count = 0) = 0;
+	void write(const ResultColumns& columns, size_t i);
+
+	// hands the buffer to out, also done on destruction
+	void flush();
+
+protected:
+	RecordWriter(std::ostream& out, size_t bufferSize);
+
+	// at least size free bytes at the end of the buffer, written up to the returned end by commit
+	char* reserve(size_t size);
+	void commit(char* end) { used = size_t(end - buffer.data()); }
+
+	static char* putDigits(char* out, const Result& result);
+	static char* putAccount(char* out, uint32_t account);
+	static char* putNumber(char* out, uint64_t value);
+	static char* putText(char* out, const char* text);
+
+private:
+	std::ostream& out;
+	std::vector<char> buffer;
+	size_t used = 0;
+};
+
+// one object per line:
+// {"offset":224,"account":"490067715","status":"AMB","candidates":["490067115","490067719"]}
+// offset null if unknown, '?' for illegible digits, status "OK" for valid accounts
+class JsonLinesWriter : public RecordWriter
+{
+public:
+	explicit JsonLinesWriter(std::ostream& out, size_t bufferSize = 1 << 16) : RecordWriter(out, bufferSize) {}
+
+	using RecordWriter::write;
+	void write(const Result& result, uint64_t offset, const uint32_t* candidates = nullptr, size_t count = 0) override;
+};
+
+// a header line "offset,account,status,candidates", then one line per record with
+// the candidates separated by ';' and an empty offset if unknown
+class CsvWriter : public RecordWriter
+{
+public:
+	explicit CsvWriter(std::ostream& out, size_t bufferSize = 1 << 16);
+
+	using RecordWriter::write;
+	void write(const Result& result, uint64_t offset, const uint32_t* candidates = nullptr, size_t count = 0) override;
+};
@@ -0,0 +1,209 @@
+#include "ResultColumns.h"
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace {
+	const char magic[8] = { 'B', 'K', 'O', 'C', 'R', 'C', 'O', 'L' };
+	const size_t headerSize = 32;
+
+	size_t align(size_t size) { return (size + 7) & ~size_t(7); }
+
+	// byte offsets of the columns behind the header
+	struct Layout
+	{
+		size_t offsets, accounts, firsts, candidates, illegible, status, end;
+
+		Layout(uint64_t entries, uint64_t candidateCount) {
+			offsets = headerSize;
+			accounts = offsets + align(entries * 8);
+			firsts = accounts + align(entries * 4);
+			candidates = firsts + align((entries + 1) * 4);
+			illegible = candidates + align(candidateCount * 4);
+			status = illegible + align(entries * 2);
+			end = status + align(entries);
+		}
+	};
+
+	const char* const statusNames[] = { "", "ERR", "ILL", "AMB", "FIX", "UNK" };
+
+	void putAccount(std::ostream& out, uint32_t account, uint16_t illegible) {
+		char digits[9];
+		for (int p = 8; p >= 0; --p, account /= 10) digits[p] = illegible >> p & 1 ? '?' : char('0' + account % 10);
+		out.write(digits, 9);
+	}
+
+	// "457508000" or "86110??36" => number and illegible bits
+	bool parseAccount(const std::string& text, uint32_t& account, uint16_t& illegible) {
+		if (text.size() != 9) return false;
+		account = 0;
+		illegible = 0;
+		for (int p = 0; p < 9; ++p) {
+			auto c = text[p];
+			if (c == '?') illegible |= 1 << p;
+			else if (c < '0' || c > '9') return false;
+			account = account * 10 + (c == '?' ? 0 : c - '0');
+		}
+		return true;
+	}
+}
+
+const uint64_t ResultColumns::noOffset;
+
+ResultColumns::ResultColumns(const std::string& path)
+	: file(path)
+{
+	auto data = file.data();
+	if (file.size() < headerSize || std::memcmp(data, magic, 8) != 0) throw std::runtime_error("not a result columns file: " + path);
+	uint64_t entries, candidateCount;
+	std::memcpy(&entries, data + 8, 8);
+	std::memcpy(&candidateCount, data + 16, 8);
+	// an entry takes at least 19 bytes and a candidate 4, so the layout of counts the file
+	// can hold does not overflow
+	if (entries > file.size() / 19 || candidateCount > file.size() / 4) throw std::runtime_error("truncated result columns file: " + path);
+	Layout layout(entries, candidateCount);
+	if (file.size() < layout.end) throw std::runtime_error("truncated result columns file: " + path);
+
+	count = size_t(entries);
+	offsets = reinterpret_cast<const uint64_t*>(data + layout.offsets);
+	accounts = reinterpret_cast<const uint32_t*>(data + layout.accounts);
+	firsts = reinterpret_cast<const uint32_t*>(data + layout.firsts);
+	candidates = reinterpret_cast<const uint32_t*>(data + layout.candidates);
+	illegible = reinterpret_cast<const uint16_t*>(data + layout.illegible);
+	status = reinterpret_cast<const unsigned char*>(data + layout.status);
+	// checked once here, so the lookups can trust the columns
+	for (size_t i = 0; i < count; ++i) {
+		if (firsts[i] > firsts[i + 1] || status[i] > unsigned(Status::unk)) throw std::runtime_error("corrupt result columns file: " + path);
+	}
+	if (firsts[count] > candidateCount) throw std::runtime_error("corrupt result columns file: " + path);
+}
+
+Result ResultColumns::getResult(size_t i) const
+{
+	Result ret = {};
+	auto account = accounts[i];
+	for (int p = 8; p >= 0; --p, account /= 10) {
+		ret.digits[p] = illegible[i] >> p & 1 ? Result::illegible : (unsigned char)(account % 10);
+	}
+	ret.status = getStatus(i);
+	return ret;
+}
+
+uint32_t getAccountNumber(const std::vector<int>& digits)
+{
+	uint32_t ret = 0;
+	for (auto d : digits) ret = ret * 10 + (d < 0 ? 0 : d);
+	return ret;
+}
+
+void ResultColumnsWriter::add(const Result& result, uint64_t offset, const std::vector<uint32_t>& repairs)
+{
+	uint32_t account = 0;
+	uint16_t ill = 0;
+	for (int p = 0; p < 9; ++p) {
+		auto d = result.digits[p];
+		if (d == Result::illegible) ill |= 1 << p;
+		account = account * 10 + (d == Result::illegible ? 0 : d);
+	}
+	offsets.push_back(offset);
+	accounts.push_back(account);
+	illegible.push_back(ill);
+	status.push_back((unsigned char)result.status);
+	candidates.insert(candidates.end(), repairs.begin(), repairs.end());
+	firsts.push_back(uint32_t(candidates.size()));
+}
+
+void ResultColumnsWriter::addDecoded(const std::vector<int>& in, uint64_t offset, const RepairOptions& options)
+{
+	auto result = getResult(in, options);
+	std::vector<uint32_t> repairs;
+	if (result.status == Status::amb) {
+		for (auto& c : getCandidates(in, options)) repairs.push_back(getAccountNumber(c));
+	}
+	add(result, offset, repairs);
+}
+
+void ResultColumnsWriter::write(std::ostream& out) const
+{
+	const uint64_t entries = accounts.size(), candidateCount = candidates.size();
+	Layout layout(entries, candidateCount);
+	std::vector<char> buffer(layout.end);
+	std::memcpy(&buffer[0], magic, 8);
+	std::memcpy(&buffer[8], &entries, 8);
+	std::memcpy(&buffer[16], &candidateCount, 8);
+	auto put = [&](size_t at, const void* column, size_t size) {
+		if (size) std::memcpy(&buffer[at], column, size);
+	};
+	put(layout.offsets, offsets.data(), entries * 8);
+	put(layout.accounts, accounts.data(), entries * 4);
+	put(layout.firsts, firsts.data(), (entries + 1) * 4);
+	put(layout.candidates, candidates.data(), candidateCount * 4);
+	put(layout.illegible, illegible.data(), entries * 2);
+	put(layout.status, status.data(), entries);
+
+	out.write(buffer.data(), std::streamsize(buffer.size()));
+}
+
+void ResultColumnsWriter::write(const std::string& path) const
+{
+	std::ofstream out(path, std::ios::binary);
+	write(out);
+	if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+void writeResultText(const ResultColumns& columns, std::ostream& out)
+{
+	for (size_t i = 0; i < columns.size(); ++i) {
+		putAccount(out, columns.getAccount(i), columns.getIllegible(i));
+		out << getStatusText(columns.getStatus(i));
+		if (columns.getCandidateCount(i)) {
+			out << " [";
+			for (size_t c = 0; c < columns.getCandidateCount(i); ++c) {
+				out << (c ? ", '" : "'");
+				putAccount(out, columns.getCandidates(i)[c], 0);
+				out << "'";
+			}
+			out << "]";
+		}
+		out << "\n";
+	}
+}
+
+ResultColumnsWriter readResultText(std::istream& in)
+{
+	ResultColumnsWriter ret;
+	std::string line;
+	while (std::getline(in, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty()) continue;
+
+		Result result = {};
+		uint32_t account;
+		uint16_t illegible;
+		if (!parseAccount(line.substr(0, 9), account, illegible)) throw std::invalid_argument("expected 9 digits: " + line);
+		for (int p = 8; p >= 0; --p, account /= 10) result.digits[p] = illegible >> p & 1 ? Result::illegible : (unsigned char)(account % 10);
+
+		auto name = line.size() > 9 ? line.substr(10, 3) : "";
+		auto status = 0;
+		while (status < 6 && name != statusNames[status]) ++status;
+		if (status == 6 || (status ? line[9] != ' ' : line.size() != 9)) throw std::invalid_argument("unknown status: " + line);
+		result.status = Status(status);
+
+		// "['490067115', '490067719']", 13 bytes per candidate
+		std::vector<uint32_t> candidates;
+		if (line.size() > 13) {
+			auto list = line.substr(13);
+			if (list.size() < 3 || list.compare(0, 2, " [") != 0 || list.back() != ']') throw std::invalid_argument("expected candidates: " + line);
+			for (size_t at = 2; at + 11 <= list.size(); at += 13) {
+				if (list[at] != '\'' || list[at + 10] != '\'' || !parseAccount(list.substr(at + 1, 9), account, illegible) || illegible)
+					throw std::invalid_argument("malformed candidate: " + line);
+				candidates.push_back(account);
+			}
+			if (list.size() != 13 * candidates.size() + 1 + (candidates.empty() ? 2 : 0)) throw std::invalid_argument("malformed candidates: " + line);
+		}
+		ret.add(result, ResultColumns::noOffset, candidates);
+	}
+	return ret;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "MappedFile.h"
+#include "OCR.h"
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// binary result file for downstream systems, read in place from a mapping
+//
+// little endian, a 32 byte header and columns each starting 8 byte aligned:
+//   header     "BKOCRCOL", uint64 entries, uint64 candidates, uint64 0
+//   offsets    uint64[entries]     byte offset of the entry in its source, noOffset if unknown
+//   accounts   uint32[entries]     the reported digits as number, illegible digits as 0
+//   firsts     uint32[entries + 1] entry i owns candidates[firsts[i]] .. candidates[firsts[i + 1] - 1]
+//   candidates uint32[candidates]  the repairs of AMB entries
+//   illegible  uint16[entries]     bit p set if digit p is illegible
+//   status     uint8[entries]      Status
+class ResultColumns
+{
+public:
+	static const uint64_t noOffset = ~uint64_t(0);
+
+	// throws std::runtime_error if the file is no result columns file, is cut short, or its
+	// candidate ranges or statuses are out of range
+	explicit ResultColumns(const std::string& path);
+
+	size_t size() const { return count; }
+
+	uint64_t getOffset(size_t i) const { return offsets[i]; }
+	uint32_t getAccount(size_t i) const { return accounts[i]; }
+	uint16_t getIllegible(size_t i) const { return illegible[i]; }
+	Status getStatus(size_t i) const { return Status(status[i]); }
+	size_t getCandidateCount(size_t i) const { return firsts[i + 1] - firsts[i]; }
+	const uint32_t* getCandidates(size_t i) const { return candidates + firsts[i]; }
+	Result getResult(size_t i) const;
+
+	// whole columns for vectorised consumers
+	const uint64_t* getOffsets() const { return offsets; }
+	const uint32_t* getAccounts() const { return accounts; }
+	const unsigned char* getStatuses() const { return status; }
+
+private:
+	MappedFile file;
+	size_t count = 0;
+	const uint64_t* offsets = nullptr;
+	const uint32_t* accounts = nullptr;
+	const uint32_t* firsts = nullptr;
+	const uint32_t* candidates = nullptr;
+	const uint16_t* illegible = nullptr;
+	const unsigned char* status = nullptr;
+};
+
+// collects the columns in memory and writes the file in one sequential write
+class ResultColumnsWriter
+{
+public:
+	void add(const Result& result, uint64_t offset = ResultColumns::noOffset, const std::vector<uint32_t>& candidates = {});
+	// result and, for AMB, the candidates of a decoded entry
+	void addDecoded(const std::vector<int>& in, uint64_t offset, const RepairOptions& options = RepairOptions());
+
+	size_t size() const { return accounts.size(); }
+	void write(const std::string& path) const;
+	void write(std::ostream& out) const;
+
+private:
+	std::vector<uint64_t> offsets;
+	std::vector<uint32_t> accounts;
+	std::vector<uint32_t> firsts = { 0 };
+	std::vector<uint32_t> candidates;
+	std::vector<uint16_t> illegible;
+	std::vector<unsigned char> status;
+};
+
+// 9 digits => number, illegible digits as 0
+uint32_t getAccountNumber(const std::vector<int>& digits);
+
+// text form: the getCheckPlus lines, AMB lines followed by the candidates as in
+// "490067715 AMB ['490067115', '490067719', '490867715']"
+void writeResultText(const ResultColumns& columns, std::ostream& out);
+// reads the text form, throws std::invalid_argument for malformed lines
+ResultColumnsWriter readResultText(std::istream& in);
@@ -0,0 +1,113 @@
+#include "Sliced.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace {
+	typedef uint64_t Plane;
+	const int lanes = 64;
+	const int sumBits = 9;	// 9 * (9 + 8 + ... + 1) = 405 < 512
+
+	struct Cell
+	{
+		Plane strokes[7];
+		Plane bad;
+	};
+
+	// a bit sliced number, least significant plane first
+	struct Number
+	{
+		Plane bits[sumBits];
+	};
+
+	void add(Number& sum, const Plane* value, int count, int shift) {
+		Plane carry = 0;
+		for (int b = shift; b < sumBits; ++b) {
+			auto v = b - shift < count ? value[b - shift] : 0;
+			auto s = sum.bits[b];
+			sum.bits[b] = s ^ v ^ carry;
+			carry = (s & v) | (carry & (s ^ v));
+		}
+	}
+
+	Plane equals(const Number& n, int value) {
+		Plane eq = ~Plane(0);
+		for (int b = 0; b < sumBits; ++b) eq &= (value >> b) & 1 ? n.bits[b] : ~n.bits[b];
+		return eq;
+	}
+
+	// cell offsets (row * width + column) and characters of the 7 strokes and the 2 blank corners
+	const int strokeOffset[7] = { 1, OCR::width, OCR::width + 1, OCR::width + 2, 2 * OCR::width, 2 * OCR::width + 1, 2 * OCR::width + 2 };
+	const char strokeChar[7] = { '_', '|', '_', '|', '|', '_', '|' };
+	const int cornerOffset[2] = { 0, 2 };
+
+	void transpose(const std::vector<std::string>& entries, size_t first, int count, Cell cells[9]) {
+		for (int i = 0; i < 9; ++i) cells[i] = Cell();
+		for (int lane = 0; lane < count; ++lane) {
+			auto& entry = entries[first + lane];
+			assert(4 * OCR::width == entry.size());
+			for (int i = 0; i < 9; ++i) {
+				auto cell = entry.data() + 3 * i;
+				Plane bad = 0;
+				for (int s = 0; s < 7; ++s) {
+					auto c = cell[strokeOffset[s]];
+					Plane stroke = c == strokeChar[s];
+					cells[i].strokes[s] |= stroke << lane;
+					bad |= Plane(c != ' ') & ~stroke;
+				}
+				for (auto o : cornerOffset) bad |= Plane(cell[o] != ' ');
+				cells[i].bad |= bad << lane;
+			}
+		}
+	}
+}
+
+std::vector<std::vector<int>> readSliced(const std::vector<std::string>& entries, std::vector<bool>* valid)
+{
+	auto& glyphs = OCR::getGlyphSet();
+	std::vector<std::vector<int>> result(entries.size(), std::vector<int>(OCR::digits));
+	if (valid) valid->assign(entries.size(), false);
+
+	for (size_t first = 0; first < entries.size(); first += lanes) {
+		auto count = int(std::min<size_t>(lanes, entries.size() - first));
+		Cell cells[9];
+		transpose(entries, first, count, cells);
+
+		Plane legible[9], values[9][4];
+		Plane allLegible = ~Plane(0);
+		Number sum = {};
+		for (int i = 0; i < 9; ++i) {
+			auto& cell = cells[i];
+			legible[i] = 0;
+			for (auto& v : values[i]) v = 0;
+			for (int d = 0; d < 10; ++d) {
+				auto mask = glyphs.getVariants(d)[0];
+				auto match = ~cell.bad;
+				for (int s = 0; s < 7; ++s) match &= (mask >> s) & 1 ? cell.strokes[s] : ~cell.strokes[s];
+				legible[i] |= match;
+				for (int b = 0; b < 4; ++b) {
+					if ((d >> b) & 1) values[i][b] |= match;
+				}
+			}
+			allLegible &= legible[i];
+			// (9 - i) * digit as shifted additions
+			for (int b = 0; b < 4; ++b) {
+				if (((9 - i) >> b) & 1) add(sum, values[i], 4, b);
+			}
+		}
+		Plane checksumOk = 0;
+		for (int k = 0; 11 * k < (1 << sumBits); ++k) checksumOk |= equals(sum, 11 * k);
+		checksumOk &= allLegible;
+
+		for (int lane = 0; lane < count; ++lane) {
+			auto& digits = result[first + lane];
+			for (int i = 0; i < 9; ++i) {
+				auto d = 0;
+				for (int b = 0; b < 4; ++b) d |= int((values[i][b] >> lane) & 1) << b;
+				digits[i] = (legible[i] >> lane) & 1 ? d : -1;
+			}
+			if (valid) (*valid)[first + lane] = (checksumOk >> lane) & 1;
+		}
+	}
+	return result;
+}
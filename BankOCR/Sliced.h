@@ -0,0 +1,10 @@
+#pragma once
+#include "OCR.h"
+
+// bit sliced decoder for throughput: 64 entries are transposed into bit planes, one
+// 64 bit word per stroke of a glyph cell, and the digit matching and the mod 11
+// checksum are evaluated as boolean circuits over all 64 lanes at once
+//
+// entries have to be 108 bytes each; valid (optional) gets whether an entry is legible
+// with a correct checksum
+std::vector<std::vector<int>> readSliced(const std::vector<std::string>& entries, std::vector<bool>* valid = nullptr);
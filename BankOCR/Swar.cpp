@@ -0,0 +1,78 @@
+#include "Swar.h"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+	const uint64_t ones = 0x0101010101010101ull;
+	const uint64_t low7 = 0x7f7f7f7f7f7f7f7full;
+	const uint64_t high = 0x8080808080808080ull;
+
+	// 0x80 in every byte of w equal to c, exact for all byte values
+	uint64_t getEqual(uint64_t w, unsigned char c) {
+		auto x = w ^ (ones * c);
+		return ~(((x & low7) + low7) | x) & high;
+	}
+
+	// high bit of byte i => bit i
+	uint32_t getBits(uint64_t flags) {
+		return uint32_t(((flags >> 7) * 0x0102040810204080ull) >> 56);
+	}
+
+	// columns 0..26 of a row whose bytes are ' ', '|' or '_'
+	struct RowBits { uint32_t space, pipe, under; };
+
+	RowBits classify(const char* row) {
+		unsigned char buf[32] = {};
+		std::memcpy(buf, row, OCR::width);
+		RowBits bits = {};
+		for (int w = 0; w < 4; ++w) {
+			// little endian load, byte i of the word is column 8w+i (a single load on LE targets)
+			uint64_t word = 0;
+			for (int b = 7; b >= 0; --b) word = word << 8 | buf[8 * w + b];
+			bits.space |= getBits(getEqual(word, ' ')) << (8 * w);
+			bits.pipe |= getBits(getEqual(word, '|')) << (8 * w);
+			bits.under |= getBits(getEqual(word, '_')) << (8 * w);
+		}
+		return bits;
+	}
+
+	const uint32_t all = (1u << 27) - 1;
+	const uint32_t left = 0x1249249u & all;
+	const uint32_t middle = left << 1;
+	const uint32_t right = left << 2;
+}
+
+std::vector<int> readSwar(const std::string& input, const GlyphSet& glyphs)
+{
+	assert(4 * OCR::width == input.size());
+	std::vector<int> result(OCR::digits);
+	readSwar(input.data(), result.data(), glyphs);
+	return result;
+}
+
+void readSwar(const char* input, int* out, const GlyphSet& glyphs)
+{
+	RowBits rows[3];
+	for (int r = 0; r < 3; ++r) rows[r] = classify(input + r * OCR::width);
+
+	// the outer columns take pipes (blank corners on top), the middle column underscores
+	auto valid = (rows[0].space & (left | right)) | ((rows[0].under | rows[0].space) & middle);
+	for (int r = 1; r < 3; ++r) {
+		valid &= ((rows[r].pipe | rows[r].space) & (left | right)) | ((rows[r].under | rows[r].space) & middle);
+	}
+	auto bad = ~valid & all;
+
+	for (int i = 0; i < OCR::digits; ++i) {
+		auto c = 3 * i;
+		auto mask = int((rows[0].under >> (c + 1)) & 1)
+			| int((rows[1].pipe >> c) & 1) << 1
+			| int((rows[1].under >> (c + 1)) & 1) << 2
+			| int((rows[1].pipe >> (c + 2)) & 1) << 3
+			| int((rows[2].pipe >> c) & 1) << 4
+			| int((rows[2].under >> (c + 1)) & 1) << 5
+			| int((rows[2].pipe >> (c + 2)) & 1) << 6;
+		auto digit = glyphs.getDigit(mask);
+		out[i] = (bad >> c) & 7 ? -1 : digit;
+	}
+}
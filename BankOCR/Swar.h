@@ -0,0 +1,9 @@
+#pragma once
+#include "OCR.h"
+
+// decoder for targets without vector units: every row is classified 8 bytes at a time in
+// 64 bit words and the stroke masks are gathered with shifts, no branch per byte or glyph;
+// gives the same digits as OCR::read
+std::vector<int> readSwar(const std::string& input, const GlyphSet& glyphs = OCR::getGlyphSet());
+// 4 * OCR::width bytes => OCR::digits digits in out, without allocating
+void readSwar(const char* input, int* out, const GlyphSet& glyphs = OCR::getGlyphSet());
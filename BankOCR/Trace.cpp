@@ -0,0 +1,243 @@
+#include "Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace {
+	std::atomic<uint64_t> nextTracer(1);
+
+	// the buffer the thread used last, found again without the lock
+	struct LastBuffer
+	{
+		uint64_t tracer;
+		void* buffer;
+	};
+	thread_local LastBuffer last = { 0, nullptr };
+
+	// set by the handler of TraceDumper, lock free so the handler may touch it
+	std::atomic<bool> signalled(false);
+
+	extern "C" void onTraceSignal(int) {
+		signalled = true;
+	}
+
+	void putString(std::ostream& out, const char* text) {
+		out << '"';
+		for (auto p = text; *p; ++p) {
+			auto c = (unsigned char)*p;
+			if (c == '"' || c == '\\') out << '\\' << char(c);
+			else if (c < 0x20) {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out << escaped;
+			}
+			else out << char(c);
+		}
+		out << '"';
+	}
+}
+
+// one event; fields are relaxed atomics as write() may read a slot that is being reused
+struct TraceEvent
+{
+	std::atomic<const char*> name;
+	std::atomic<const char*> category;
+	std::atomic<uint64_t> start;
+	std::atomic<uint64_t> duration;
+	std::atomic<int64_t> value;
+	// 'X' span, 'C' counter
+	std::atomic<char> phase;
+};
+
+struct Tracer::Buffer
+{
+	explicit Buffer(size_t capacity) : events(new TraceEvent[capacity]), count(0), reserved(0), owner(std::this_thread::get_id()) {}
+
+	// single writer, a sequence lock: the slot is reserved, filled, then published by the count
+	void add(char phase, const char* name, const char* category, uint64_t start, uint64_t duration, int64_t value, size_t capacity) {
+		auto n = count.load(std::memory_order_relaxed);
+		reserved.store(n + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		auto& e = events[n % capacity];
+		e.name.store(name, std::memory_order_relaxed);
+		e.category.store(category, std::memory_order_relaxed);
+		e.start.store(start, std::memory_order_relaxed);
+		e.duration.store(duration, std::memory_order_relaxed);
+		e.value.store(value, std::memory_order_relaxed);
+		e.phase.store(phase, std::memory_order_relaxed);
+		count.store(n + 1, std::memory_order_release);
+	}
+
+	std::unique_ptr<TraceEvent[]> events;
+	std::atomic<uint64_t> count;
+	// events written or being written
+	std::atomic<uint64_t> reserved;
+	std::thread::id owner;
+	// guarded by the tracer's mutex
+	std::string threadName;
+};
+
+Tracer::Tracer(size_t capacity)
+	: capacity(capacity ? capacity : 1), id(nextTracer++), origin(getTicks())
+{
+}
+
+Tracer::~Tracer()
+{
+}
+
+Tracer::Buffer& Tracer::getBuffer()
+{
+	if (last.tracer == id) return *static_cast<Buffer*>(last.buffer);
+	std::lock_guard<std::mutex> lock(mutex);
+	Buffer* buffer = nullptr;
+	for (auto& b : buffers) {
+		if (b->owner == std::this_thread::get_id()) buffer = b.get();
+	}
+	if (!buffer) {
+		buffers.emplace_back(new Buffer(capacity));
+		buffer = buffers.back().get();
+	}
+	last.tracer = id;
+	last.buffer = buffer;
+	return *buffer;
+}
+
+void Tracer::span(const char* name, const char* category, uint64_t start, uint64_t end, int64_t value)
+{
+	getBuffer().add('X', name, category, start, end > start ? end - start : 0, value, capacity);
+}
+
+void Tracer::counter(const char* name, int64_t value)
+{
+	getBuffer().add('C', name, "", getTicks(), 0, value, capacity);
+}
+
+void Tracer::setThreadName(const std::string& name)
+{
+	auto& buffer = getBuffer();
+	std::lock_guard<std::mutex> lock(mutex);
+	buffer.threadName = name;
+}
+
+size_t Tracer::getEvents() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t n = 0;
+	for (auto& b : buffers) n += size_t(std::min<uint64_t>(b->count.load(std::memory_order_acquire), capacity));
+	return n;
+}
+
+void Tracer::write(std::ostream& out) const
+{
+	const auto micros = 1e6 / getTicksPerSecond();
+	char number[32];
+	auto time = [&](uint64_t ticks) {
+		std::snprintf(number, sizeof(number), "%.3f", double(ticks) * micros);
+		return number;
+	};
+
+	std::lock_guard<std::mutex> lock(mutex);
+	out << "{\"traceEvents\":[";
+	auto first = true;
+	auto separate = [&] {
+		out << (first ? "\n" : ",\n");
+		first = false;
+	};
+	for (size_t t = 0; t < buffers.size(); ++t) {
+		const auto& b = *buffers[t];
+		const auto tid = t + 1;
+		if (!b.threadName.empty()) {
+			separate();
+			out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+			putString(out, b.threadName.c_str());
+			out << "}}";
+		}
+
+		// copied first, then the slots the writer reserved meanwhile are dropped
+		auto end = b.count.load(std::memory_order_acquire);
+		auto begin = end > capacity ? end - capacity : 0;
+		struct Copy { const char* name; const char* category; uint64_t start, duration; int64_t value; char phase; };
+		std::vector<Copy> copies;
+		for (auto i = begin; i < end; ++i) {
+			const auto& e = b.events[i % capacity];
+			copies.push_back({ e.name.load(std::memory_order_relaxed), e.category.load(std::memory_order_relaxed),
+				e.start.load(std::memory_order_relaxed), e.duration.load(std::memory_order_relaxed),
+				e.value.load(std::memory_order_relaxed), e.phase.load(std::memory_order_relaxed) });
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		auto reached = b.reserved.load(std::memory_order_relaxed);
+		auto valid = reached > capacity ? reached - capacity : 0;
+
+		for (auto i = begin; i < end; ++i) {
+			if (i < valid) continue;
+			const auto& e = copies[size_t(i - begin)];
+			auto start = e.start > origin ? e.start - origin : 0;
+			separate();
+			out << "{\"name\":";
+			putString(out, e.name);
+			if (e.phase == 'C') {
+				out << ",\"ph\":\"C\",\"ts\":" << time(start) << ",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"value\":" << e.value << "}}";
+				continue;
+			}
+			out << ",\"cat\":";
+			putString(out, e.category);
+			out << ",\"ph\":\"X\",\"ts\":" << time(start);
+			out << ",\"dur\":" << time(e.duration) << ",\"pid\":1,\"tid\":" << tid;
+			if (e.value >= 0) out << ",\"args\":{\"value\":" << e.value << "}";
+			out << "}";
+		}
+	}
+	out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void Tracer::write(const std::string& path) const
+{
+	const auto temp = path + ".tmp";
+	{
+		std::ofstream out(temp, std::ios::binary);
+		write(out);
+		if (!out.flush()) throw std::runtime_error("cannot write " + temp);
+	}
+#ifdef _WIN32
+	auto ok = MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	auto ok = std::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+	if (!ok) throw std::runtime_error("cannot replace " + path);
+}
+
+TraceDumper::TraceDumper(const std::string& path, const Tracer& tracer, int signal)
+	: path(path), tracer(tracer), signal(signal), done(false)
+{
+	signalled = false;
+	previous = std::signal(signal, onTraceSignal);
+	if (previous == SIG_ERR) throw std::runtime_error("cannot handle signal " + std::to_string(signal));
+	thread = std::thread([this] {
+		while (!done) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			if (!signalled.exchange(false)) continue;
+			try {
+				this->tracer.write(this->path);
+			}
+			catch (const std::exception&) {
+				// the next signal tries again
+			}
+			// handlers are reset on delivery where signal() has System V semantics (and on Windows)
+			std::signal(this->signal, onTraceSignal);
+		}
+	});
+}
+
+TraceDumper::~TraceDumper()
+{
+	done = true;
+	thread.join();
+	std::signal(signal, previous);
+}
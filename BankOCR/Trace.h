@@ -0,0 +1,95 @@
+#pragma once
+#include "Latency.h"
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// spans of work per thread on a timeline, written as Chrome trace-event JSON for
+// chrome://tracing or Perfetto; every thread records into a ring buffer of its own
+// holding its last 'capacity' events, without locks once the thread has its buffer
+//
+// names and categories are kept as pointers, they have to outlive the tracer (literals)
+class Tracer
+{
+public:
+	explicit Tracer(size_t capacity = 1 << 16);
+	~Tracer();
+
+	// a span of the calling thread between two getTicks time stamps, value shown as argument if >= 0
+	void span(const char* name, const char* category, uint64_t start, uint64_t end, int64_t value = -1);
+	// a sample of a counter track, such as a queue depth
+	void counter(const char* name, int64_t value);
+	// label of the calling thread's track
+	void setThreadName(const std::string& name);
+
+	// events held in the buffers
+	size_t getEvents() const;
+
+	// {"traceEvents":[...]} with times in microseconds since the tracer was created;
+	// may run while threads record, events overwritten meanwhile are left out
+	void write(std::ostream& out) const;
+	// written to path.tmp, then renamed over path; throws std::runtime_error if it cannot be written
+	void write(const std::string& path) const;
+
+private:
+	struct Buffer;
+	Buffer& getBuffer();
+
+	size_t capacity;
+	uint64_t id;
+	uint64_t origin;
+	mutable std::mutex mutex;
+	std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+// records the span from construction to destruction, costs a null check without a tracer
+class TraceSpan
+{
+public:
+	TraceSpan(Tracer* tracer, const char* name, const char* category, int64_t value = -1)
+		: tracer(tracer), name(name), category(category), value(value), start(tracer ? getTicks() : 0) {}
+	~TraceSpan() {
+		if (tracer) tracer->span(name, category, start, getTicks(), value);
+	}
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+	void setValue(int64_t v) { value = v; }
+
+private:
+	Tracer* tracer;
+	const char* name;
+	const char* category;
+	int64_t value;
+	uint64_t start;
+};
+
+#ifdef SIGUSR1
+const int traceSignal = SIGUSR1;
+#else
+const int traceSignal = SIGBREAK;
+#endif
+
+// writes the trace to path each time the process gets the signal, from a thread that checks
+// a flag set by the handler every 50 ms; one at a time per process, the previous handler is
+// restored on destruction
+class TraceDumper
+{
+public:
+	TraceDumper(const std::string& path, const Tracer& tracer, int signal = traceSignal);
+	~TraceDumper();
+
+private:
+	std::string path;
+	const Tracer& tracer;
+	int signal;
+	void (*previous)(int);
+	std::atomic<bool> done;
+	std::thread thread;
+};
@@ -0,0 +1,335 @@
+#include "Allocations.h"
+#include "Format.h"
+#include "OCR.h"
+#include "RecordWriter.h"
+#include "ResultColumns.h"
+#include "Sliced.h"
+#include "Swar.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace {
+	typedef std::vector<std::string> Entries;
+
+	struct Benchmark
+	{
+		const char* name;
+		// returns a value depending on all results, so nothing is optimised away
+		std::function<long(const Entries&)> run;
+	};
+
+	// valid glyphs, every 16th entry with a damaged byte
+	Entries makeEntries(size_t count) {
+		std::mt19937 rng(2017);
+		std::uniform_int_distribution<int> digit(0, 9), pos(0, 80);
+		Entries entries;
+		for (size_t n = 0; n < count; ++n) {
+			std::vector<int> digits(OCR::digits);
+			for (auto& d : digits) d = digit(rng);
+			auto input = OCR::render(digits);
+			if (n % 16 == 0) input[pos(rng)] = 'x';
+			entries.push_back(input);
+		}
+		return entries;
+	}
+
+	// counts and drops what the writers produce
+	class CountingBuffer : public std::streambuf
+	{
+	public:
+		long count = 0;
+
+	protected:
+		std::streamsize xsputn(const char*, std::streamsize n) override { count += long(n); return n; }
+		int overflow(int c) override { ++count; return c; }
+	};
+
+	// decoded once per entry set; the first repeat pays for it, best of the repeats drops it
+	const std::vector<Result>& getResults(const Entries& entries) {
+		static const Entries* cached = nullptr;
+		static std::vector<Result> results;
+		if (cached != &entries) {
+			results.clear();
+			for (auto& e : entries) results.push_back(getResult(OCR::read(e)));
+			cached = &entries;
+		}
+		return results;
+	}
+
+	// AMB entries get three candidates, enough to exercise the lists
+	const uint32_t candidates[] = { 490067115, 490067719, 490867715 };
+
+	// the formatter alone on the cached results, into a buffer kept across runs
+	template <size_t (*Format)(const Result*, size_t, char*)>
+	long formatRecords(const Entries& entries) {
+		auto& results = getResults(entries);
+		static std::vector<char> out;
+		out.resize(getFormatSize(results.size()));
+		return long(Format(results.data(), results.size(), out.data()));
+	}
+
+	template <class Writer>
+	long writeRecords(const Entries& entries) {
+		auto& results = getResults(entries);
+		CountingBuffer buffer;
+		std::ostream out(&buffer);
+		{
+			Writer writer(out);
+			for (size_t i = 0; i < results.size(); ++i) {
+				auto amb = results[i].status == Status::amb;
+				writer.write(results[i], 112 * i, amb ? candidates : nullptr, amb ? 3 : 0);
+			}
+		}
+		return buffer.count;
+	}
+
+	// hardware counters of this thread around a benchmark run, each opened on its own so
+	// the ones the machine has still count; none where perf events are not permitted. With
+	// more counters than the PMU has, the kernel multiplexes them: each one is scaled from
+	// the time it ran to the whole run and flagged as an estimate
+	class PerfCounters
+	{
+	public:
+		static const int count = 5;
+
+		PerfCounters() {
+			for (auto& fd : fds) fd = -1;
+#ifdef __linux__
+			const uint64_t cache = PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+			const std::pair<uint32_t, uint64_t> events[count] = {
+				{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+				{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+				{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+				{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache },
+				{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | cache } };
+			for (int i = 0; i < count; ++i) {
+				perf_event_attr attr;
+				std::memset(&attr, 0, sizeof(attr));
+				attr.size = sizeof(attr);
+				attr.type = events[i].first;
+				attr.config = events[i].second;
+				attr.disabled = 1;
+				attr.exclude_kernel = 1;
+				attr.exclude_hv = 1;
+				attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+				fds[i] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+				if (fds[i] < 0 && error.empty()) error = std::strerror(errno);
+			}
+#else
+			error = "perf events need Linux";
+#endif
+		}
+		~PerfCounters() {
+#ifdef __linux__
+			for (auto fd : fds) {
+				if (fd >= 0) close(fd);
+			}
+#endif
+		}
+
+		bool isAvailable() const {
+			return std::any_of(std::begin(fds), std::end(fds), [](int fd) { return fd >= 0; });
+		}
+		// why a counter could not be opened
+		const std::string& getError() const { return error; }
+
+		void start() {
+#ifdef __linux__
+			for (auto fd : fds) {
+				if (fd < 0) continue;
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+#endif
+		}
+		// -1 for the counters that are not available or never ran, scaled marks the multiplexed ones
+		void stop(long long values[count], bool scaled[count]) {
+			for (int i = 0; i < count; ++i) {
+				values[i] = -1;
+				scaled[i] = false;
+#ifdef __linux__
+				if (fds[i] < 0) continue;
+				ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+				// value, time enabled, time running
+				uint64_t v[3];
+				if (read(fds[i], v, sizeof(v)) != ssize_t(sizeof(v)) || v[2] == 0) continue;
+				values[i] = (long long)v[0];
+				if (v[2] < v[1]) {
+					values[i] = (long long)(double(v[0]) * v[1] / v[2]);
+					scaled[i] = true;
+				}
+#endif
+			}
+		}
+
+	private:
+		int fds[count];
+		std::string error;
+	};
+
+	// counter per entry, "-" if not available, "*" if scaled
+	std::string getPerEntry(long long value, size_t entries, bool scaled = false) {
+		if (value < 0) return "-";
+		char text[32];
+		std::snprintf(text, sizeof(text), "%.2f%s", double(value) / entries, scaled ? "*" : "");
+		return text;
+	}
+
+	long sum(const std::vector<int>& digits) {
+		long ret = 0;
+		for (auto d : digits) ret = ret * 3 + d;
+		return ret;
+	}
+
+	const Benchmark benchmarks[] = {
+		{ "read (table)", [](const Entries& entries) {
+			long ret = 0;
+			for (auto& e : entries) ret += sum(OCR::read(e));
+			return ret;
+		} },
+		{ "read into array", [](const Entries& entries) {
+			long ret = 0;
+			int digits[OCR::digits];
+			for (auto& e : entries) {
+				OCR::read(e.data(), digits);
+				long v = 0;
+				for (auto d : digits) v = v * 3 + d;
+				ret += v;
+			}
+			return ret;
+		} },
+		{ "readSwar", [](const Entries& entries) {
+			long ret = 0;
+			for (auto& e : entries) ret += sum(readSwar(e));
+			return ret;
+		} },
+		{ "readSliced (64 lanes)", [](const Entries& entries) {
+			long ret = 0;
+			for (auto& digits : readSliced(entries)) ret += sum(digits);
+			return ret;
+		} },
+		{ "read + getCheckSum", [](const Entries& entries) {
+			long ret = 0;
+			for (auto& e : entries) {
+				auto digits = OCR::read(e);
+				ret += std::find(digits.begin(), digits.end(), -1) == digits.end() ? getCheckSum(digits) : 0;
+			}
+			return ret;
+		} },
+		{ "readSliced + checksum", [](const Entries& entries) {
+			std::vector<bool> valid;
+			readSliced(entries, &valid);
+			return long(std::count(valid.begin(), valid.end(), true));
+		} },
+		{ "getCheckPlus strings", [](const Entries& entries) {
+			std::string out;
+			for (auto& e : entries) out += getCheckPlus(OCR::read(e)) + "\n";
+			return long(out.size());
+		} },
+		{ "getResult + format", [](const Entries& entries) {
+			std::vector<Result> results;
+			for (auto& e : entries) results.push_back(getResult(OCR::read(e)));
+			std::vector<char> out(getFormatSize(results.size()));
+			return long(formatResults(results.data(), results.size(), out.data()));
+		} },
+		{ "formatResults", formatRecords<formatResults> },
+		{ "formatResultsPortable", formatRecords<formatResultsPortable> },
+		{ "formatFixed", formatRecords<formatFixed> },
+		{ "write JSON Lines", writeRecords<JsonLinesWriter> },
+		{ "write CSV", writeRecords<CsvWriter> },
+		{ "write columns", [](const Entries& entries) {
+			auto& results = getResults(entries);
+			ResultColumnsWriter writer;
+			for (size_t i = 0; i < results.size(); ++i) {
+				auto amb = results[i].status == Status::amb;
+				writer.add(results[i], 112 * i, amb ? std::vector<uint32_t>(candidates, candidates + 3) : std::vector<uint32_t>());
+			}
+			CountingBuffer buffer;
+			std::ostream out(&buffer);
+			writer.write(out);
+			return buffer.count;
+		} },
+	};
+}
+
+// usage: bench [entries] [repeats] [--perf]
+int main(int argc, char** argv) {
+	std::vector<std::string> args(argv + 1, argv + argc);
+	auto perf = std::find(args.begin(), args.end(), "--perf");
+	auto usePerf = perf != args.end();
+	if (usePerf) args.erase(perf);
+	auto count = args.size() > 0 ? std::stoul(args[0]) : 200000ul;
+	auto repeats = args.size() > 1 ? std::stoi(args[1]) : 5;
+	auto entries = makeEntries(count);
+
+	std::unique_ptr<PerfCounters> counters;
+	if (usePerf) {
+		counters.reset(new PerfCounters());
+		if (!counters->isAvailable()) {
+			std::printf("perf counters unavailable (%s), timing only\n", counters->getError().c_str());
+			counters.reset();
+		}
+	}
+
+	// heap use of the last repeat, when the caches are warm
+	auto allocations = isCountingAllocations();
+	std::printf("%-24s %12s %12s", "benchmark", "ns/entry", "MB/s");
+	if (allocations) std::printf(" %10s %10s", "allocs", "bytes");
+	if (counters) std::printf(" %10s %10s %6s %10s %10s %10s", "cycles", "instr", "IPC", "br-miss", "L1d-miss", "LLC-miss");
+	std::printf("\n");
+	auto multiplexed = false;
+	for (auto& b : benchmarks) {
+		// best of the repeats, with the counters of that repeat
+		auto best = 1e30;
+		long check = 0;
+		long long values[PerfCounters::count] = { -1, -1, -1, -1, -1 };
+		bool scaled[PerfCounters::count] = {};
+		AllocationCount heap;
+		for (int r = 0; r < repeats; ++r) {
+			long long run[PerfCounters::count];
+			bool runScaled[PerfCounters::count];
+			auto heapStart = getAllocations();
+			if (counters) counters->start();
+			auto start = std::chrono::steady_clock::now();
+			check += b.run(entries);
+			std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+			if (counters) counters->stop(run, runScaled);
+			heap = getAllocations() - heapStart;
+			if (took.count() < best) {
+				best = took.count();
+				if (counters) {
+					std::copy(run, run + PerfCounters::count, values);
+					std::copy(runScaled, runScaled + PerfCounters::count, scaled);
+				}
+			}
+		}
+		std::printf("%-24s %12.1f %12.1f", b.name, 1e9 * best / count, count * 4.0 * OCR::width / best / 1e6);
+		if (allocations) std::printf(" %10.2f %10.1f", double(heap.allocations) / count, double(heap.bytes) / count);
+		if (counters) {
+			auto ipc = values[0] > 0 && values[1] >= 0 ? getPerEntry(values[1] * 1000 / values[0], 1000, scaled[0] || scaled[1]) : "-";
+			std::printf(" %10s %10s %6s %10s %10s %10s", getPerEntry(values[0], count, scaled[0]).c_str(), getPerEntry(values[1], count, scaled[1]).c_str(),
+				ipc.c_str(), getPerEntry(values[2], count, scaled[2]).c_str(), getPerEntry(values[3], count, scaled[3]).c_str(),
+				getPerEntry(values[4], count, scaled[4]).c_str());
+			multiplexed = multiplexed || std::find(scaled, scaled + PerfCounters::count, true) != scaled + PerfCounters::count;
+		}
+		std::printf("   (%ld)\n", check % 1000);
+	}
+	if (multiplexed) std::printf("* counter multiplexed, scaled from the time it ran\n");
+	return 0;
+}
@@ -0,0 +1,86 @@
+#include "Allocations.h"
+#include "KnownAccounts.h"
+#include "OCR.h"
+#include "Swar.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+
+// per API budgets, enforced where Allocations.cpp is built with BANKOCR_COUNT_ALLOCATIONS
+// (the Tests project compiles its own copy with it)
+namespace {
+	const std::string input =
+		"    _  _     _  _  _  _  _ "
+		"  | _| _||_||_ |_   ||_||_|"
+		"  ||_  _|  | _||_|  ||_| _|"
+		"                           ";
+
+	// valid, ERR, ILL, AMB and FIX accounts
+	const std::vector<std::vector<int>> accounts = {
+		{ 1,2,3,4,5,6,7,8,9 }, { 1,1,1,1,1,1,1,1,2 }, { 8,6,1,1,0,-1,-1,3,6 }, { 4,9,0,0,6,7,7,1,5 }, { 6,6,4,3,7,1,4,9,5 } };
+
+	class AllocationTest : public ::testing::Test
+	{
+	protected:
+		void SetUp() override {
+			// static tables are built once, outside the budgets
+			OCR::read(input);
+			readSwar(input);
+			getResult(accounts[0]);
+			ChecksumScheme::getLuhn();
+		}
+
+		// gtest 1.8 cannot skip, so a build without the hooks says it checked nothing
+		static bool isCounting() {
+			if (!isCountingAllocations()) std::printf("[ SKIPPED  ] allocation counting is off, no budget checked\n");
+			return isCountingAllocations();
+		}
+	};
+}
+
+TEST_F(AllocationTest, counts) {
+	if (!isCounting()) return;
+	auto count = countAllocations([] {
+		// volatile, so the pair is not elided
+		int* volatile p = new int(1);
+		delete p;
+	});
+	EXPECT_EQ(1u, count.allocations);
+	EXPECT_EQ(sizeof(int), count.bytes);
+	EXPECT_EQ(1u, count.frees);
+	EXPECT_EQ(1u, countAllocations([] { OCR::read(input); }).allocations);
+}
+
+TEST_F(AllocationTest, decodeIsFree) {
+	if (!isCounting()) return;
+	int digits[OCR::digits];
+	EXPECT_EQ(0u, countAllocations([&] { OCR::read(input.data(), digits); }).allocations);
+	EXPECT_EQ(0u, countAllocations([&] { readSwar(input.data(), digits); }).allocations);
+	EXPECT_EQ(7, digits[6]);
+}
+
+TEST_F(AllocationTest, validateIsFree) {
+	if (!isCounting()) return;
+	for (auto& a : accounts) {
+		EXPECT_EQ(0u, countAllocations([&] { getResult(a); }).allocations);
+	}
+	EXPECT_EQ(0u, countAllocations([] { getCheckSum(accounts[0]); }).allocations);
+	EXPECT_EQ(0u, countAllocations([] { ChecksumScheme::getLuhn().getCheckSum(accounts[1]); }).allocations);
+}
+
+TEST_F(AllocationTest, repairIsBounded) {
+	if (!isCounting()) return;
+	for (auto& a : accounts) {
+		// the returned string at most
+		EXPECT_GE(1u, countAllocations([&] { getCheckPlus(a); }).allocations);
+		EXPECT_GE(1u, countAllocations([&] { getCheck(a); }).allocations);
+		// the argument, the results and their two accounts
+		EXPECT_GE(4u, countAllocations([&] { checkReplace(a[0] < 0 ? accounts[0] : a); }).allocations);
+	}
+	// known accounts copy the account once for the lookups
+	writeKnownAccounts("known_allocations.bin", { 490067115, 490867715 }, true);
+	KnownAccounts known("known_allocations.bin");
+	RepairOptions options;
+	options.known = &known;
+	EXPECT_GE(1u, countAllocations([&] { getResult(accounts[3], options); }).allocations);
+}
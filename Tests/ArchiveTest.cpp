@@ -0,0 +1,122 @@
+#include "Archive.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace {
+	std::vector<int> getAccount(size_t n) {
+		std::vector<int> ret;
+		for (int p = 0; p < 9; ++p) ret.push_back(int((n * 7 + p * 3) % 10));
+		return ret;
+	}
+
+	// entry n with "\r\n" on every third entry and trailing blanks trimmed on every fifth
+	std::string getArt(size_t n) {
+		auto entry = OCR::render(getAccount(n));
+		std::string ret;
+		for (int row = 0; row < 4; ++row) {
+			auto line = entry.substr(row * OCR::width, OCR::width);
+			if (n % 5 == 0) line.erase(line.find_last_not_of(' ') + 1);
+			ret += line + (n % 3 == 0 ? "\r\n" : "\n");
+		}
+		return ret;
+	}
+
+	const size_t entries = 200;
+
+	void writeArchive(const std::string& path) {
+		std::ofstream out(path, std::ios::binary);
+		for (size_t n = 0; n < entries; ++n) out << getArt(n);
+		out << "\n\n";
+	}
+}
+
+TEST(ArchiveTest, frameEntry) {
+	const std::string data = " _ \r\n| |\n|_|";
+	std::string entry(4 * OCR::width, 'x');
+	EXPECT_EQ(data.size(), frameEntry(data.data(), data.size(), 0, &entry[0]));
+	EXPECT_EQ(" _ ", entry.substr(0, 3));
+	EXPECT_EQ(std::string(OCR::width - 3, ' '), entry.substr(3, OCR::width - 3));
+	EXPECT_EQ("| |", entry.substr(OCR::width, 3));
+	EXPECT_EQ("|_|", entry.substr(2 * OCR::width, 3));
+	EXPECT_EQ(std::string(OCR::width, ' '), entry.substr(3 * OCR::width));
+}
+
+TEST(ArchiveTest, randomAccess) {
+	writeArchive("archive.txt");
+	writeEntryIndex("archive.txt", "archive.idx", 16);
+	{
+		ScanArchive archive("archive.txt", "archive.idx");
+		ASSERT_EQ(entries, archive.size());
+		uint64_t offset = 0;
+		for (size_t n = 0; n < entries; ++n) {
+			EXPECT_EQ(offset, archive.getOffset(n));
+			offset += getArt(n).size();
+		}
+		EXPECT_EQ(getAccount(0), archive.read(0));
+		EXPECT_EQ(getAccount(37), archive.read(37));
+		EXPECT_EQ(getAccount(199), archive.read(199));
+		auto range = archive.read(30, 20);
+		ASSERT_EQ(20u, range.size());
+		for (size_t n = 0; n < 20; ++n) EXPECT_EQ(getAccount(30 + n), range[n]);
+		EXPECT_THROW(archive.read(entries), std::out_of_range);
+		EXPECT_THROW(archive.read(190, 11), std::out_of_range);
+	}
+	// the deltas take a byte per entry
+	std::ifstream index("archive.idx", std::ios::binary | std::ios::ate);
+	EXPECT_EQ(32 + 13 * 16 + (entries - 13), size_t(index.tellg()));
+	index.close();
+
+	// stale index
+	{
+		std::ofstream out("archive.txt", std::ios::binary | std::ios::app);
+		out << getArt(0);
+	}
+	EXPECT_THROW(ScanArchive("archive.txt", "archive.idx"), std::runtime_error);
+	std::remove("archive.txt");
+	std::remove("archive.idx");
+}
+
+TEST(ArchiveTest, rejectsCorruptIndex) {
+	writeArchive("archive.txt");
+	writeEntryIndex("archive.txt", "archive.idx", 16);
+	std::string file;
+	{
+		std::ifstream in("archive.idx", std::ios::binary);
+		std::ostringstream text;
+		text << in.rdbuf();
+		file = text.str();
+	}
+	auto write = [](const std::string& data) {
+		std::ofstream out("archive.idx", std::ios::binary | std::ios::trunc);
+		out << data;
+	};
+
+	// entries that wrap the checkpoint count around to 0
+	auto corrupt = file;
+	uint64_t entries = ~uint64_t(0) - 14;
+	std::memcpy(&corrupt[8], &entries, 8);
+	write(corrupt);
+	EXPECT_THROW(EntryIndex("archive.idx"), std::runtime_error);
+
+	// more checkpoints than the file holds
+	corrupt = file;
+	entries = file.size();
+	std::memcpy(&corrupt[8], &entries, 8);
+	write(corrupt);
+	EXPECT_THROW(EntryIndex("archive.idx"), std::runtime_error);
+
+	write(file);
+	EXPECT_NO_THROW(EntryIndex("archive.idx"));
+	std::remove("archive.txt");
+	std::remove("archive.idx");
+}
+
+TEST(ArchiveTest, rejectsOtherFiles) {
+	writeArchive("archive_other.txt");
+	EXPECT_THROW(EntryIndex("archive_other.txt"), std::runtime_error);
+	std::remove("archive_other.txt");
+}
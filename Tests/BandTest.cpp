@@ -0,0 +1,46 @@
+#include "OCR.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+	const std::string entry[4] = {
+		"    _  _     _  _  _  _  _ ",
+		"  | _| _||_||_ |_   ||_||_|",
+		"  ||_  _|  | _||_|  ||_| _|",
+		"                           " };
+	const std::string zeros[4] = {
+		" _  _  _  _  _  _  _  _  _ ",
+		"| || || || || || || || || |",
+		"|_||_||_||_||_||_||_||_||_|",
+		"                           " };
+}
+
+TEST(BandTest, singleAccount) {
+	auto band = OCR::readBand(entry[0] + entry[1] + entry[2] + entry[3]);
+	ASSERT_EQ(1u, band.size());
+	EXPECT_EQ(OCR::read(entry[0] + entry[1] + entry[2] + entry[3]), band[0]);
+}
+
+TEST(BandTest, accountsSideBySide) {
+	std::string input;
+	for (int r = 0; r < 4; ++r) input += entry[r] + zeros[r] + entry[r] + zeros[r];
+	auto band = OCR::readBand(input);
+	ASSERT_EQ(4u, band.size());
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,9 }), band[0]);
+	EXPECT_EQ(std::vector<int>({ 0,0,0,0,0,0,0,0,0 }), band[1]);
+	EXPECT_EQ(band[0], band[2]);
+	EXPECT_EQ(band[1], band[3]);
+}
+
+TEST(BandTest, illegibleAndNoisyGlyphs) {
+	std::string input;
+	for (int r = 0; r < 4; ++r) input += zeros[r] + entry[r];
+	input[54] = 'l';
+	input[54 + 27 + 2] = '!';
+	auto band = OCR::readBand(input);
+	EXPECT_EQ(-1, band[0][0]);
+	EXPECT_EQ(-1, band[1][0]);
+	band = OCR::readBand(input, OCR::getGlyphSet(), ByteClasses::getTolerant());
+	EXPECT_EQ(0, band[0][0]);
+	EXPECT_EQ(1, band[1][0]);
+}
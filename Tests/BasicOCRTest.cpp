@@ -0,0 +1,40 @@
+#include "BasicOCR.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+	// plain digit sum modulo 10
+	struct DigitSum
+	{
+		static const int modulus = 10;
+		static const int target = 0;
+		static int weight(int, int digit) { return digit; }
+	};
+
+	using OCR10 = BasicOCR<KataFont, 10>;
+	using OCR12 = BasicOCR<KataFont, 12, DigitSum>;
+}
+
+TEST(BasicOCRTest, readsTenDigits) {
+	std::string input =
+		"    _  _     _  _  _  _  _  _ "
+		"  | _| _||_||_ |_   ||_||_|| |"
+		"  ||_  _|  | _||_|  ||_| _||_|"
+		"                              ";
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,9,0 }), OCR10::read(input));
+	EXPECT_EQ(30, OCR10::width);
+}
+
+TEST(BasicOCRTest, tenDigitWeights) {
+	// 10*1 + 9*2 + ... + 2*3 + 1*0 = 198 = 18 * 11
+	EXPECT_EQ(0, OCR10::getCheckSum({ 1,2,3,4,5,6,7,8,3,0 }));
+	EXPECT_EQ("1234567830", OCR10::getCheck({ 1,2,3,4,5,6,7,8,3,0 }));
+	EXPECT_EQ("1234567890 ERR", OCR10::getCheck({ 1,2,3,4,5,6,7,8,9,0 }));
+}
+
+TEST(BasicOCRTest, twelveDigitsOtherRule) {
+	EXPECT_EQ("123456789014", OCR12::getCheckPlus({ 1,2,3,4,5,6,7,8,9,0,1,4 }));
+	EXPECT_EQ("12345678?014 ILL", OCR12::getCheckPlus({ 1,2,3,4,5,6,7,8,-1,0,1,4 }));
+	EXPECT_EQ("123456789013 AMB", OCR12::getCheckPlus({ 1,2,3,4,5,6,7,8,9,0,1,3 }));
+	EXPECT_EQ("222222222255 FIX", OCR12::getCheckPlus({ 2,2,2,2,2,2,2,2,2,2,5,9 }));
+}
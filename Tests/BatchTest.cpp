@@ -0,0 +1,189 @@
+#include "Batch.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+	std::vector<int> getAccount(size_t n) {
+		std::vector<int> ret;
+		for (int p = 0; p < 9; ++p) ret.push_back(int((n * 7 + p * 3 + n / 10) % 10));
+		return ret;
+	}
+
+	const size_t entries = 10000;
+
+	// every 7th entry with a damaged glyph
+	void writeArchive(const std::string& path, std::string& expected, size_t count = entries, bool append = false) {
+		std::ofstream out(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+		for (size_t n = append ? entries : 0; n < count; ++n) {
+			auto entry = OCR::render(getAccount(n));
+			if (n % 7 == 0) entry[OCR::width + 4] = 'x';
+			for (int row = 0; row < 4; ++row) out << entry.substr(row * OCR::width, OCR::width) << "\n";
+			expected += getCheckPlus(OCR::read(entry)) + "\n";
+		}
+	}
+
+	std::string readFile(const std::string& path) {
+		std::ifstream in(path, std::ios::binary);
+		std::ostringstream text;
+		text << in.rdbuf();
+		return text.str();
+	}
+
+	bool exists(const std::string& path) {
+		return bool(std::ifstream(path));
+	}
+}
+
+TEST(BatchTest, wholeInput) {
+	std::string expected;
+	writeArchive("batch_in.txt", expected);
+	StageLatency latency;
+	Tracer tracer;
+	BatchOptions options;
+	options.latency = &latency;
+	options.latencySample = 1;
+	options.trace = &tracer;
+	auto stats = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(entries, stats.entries);
+	// chunk, frame, decode and output per chunk
+	EXPECT_EQ(4 * ((entries + 4095) / 4096), tracer.getEvents());
+	EXPECT_EQ(entries, latency[Stage::frame].getCount());
+	EXPECT_EQ(entries, latency[Stage::validate].getCount());
+	EXPECT_EQ(stats.errors.status[int(Status::err)] + stats.errors.status[int(Status::amb)] + stats.errors.status[int(Status::fix)],
+		latency[Stage::repair].getCount());
+	EXPECT_EQ((entries + 4095) / 4096, latency[Stage::output].getCount());
+	EXPECT_EQ(entries, stats.errors.getEntries());
+	EXPECT_EQ(entries / 7 + 1, stats.errors.status[int(Status::ill)]);
+	EXPECT_EQ(expected, readFile("batch_out.txt"));
+	std::remove("batch_in.txt");
+	std::remove("batch_out.txt");
+}
+
+TEST(BatchTest, resumesFromJournal) {
+	std::string expected;
+	writeArchive("batch_in.txt", expected);
+	BatchOptions options;
+	options.journal = "batch.journal";
+	options.checkpointBytes = 1 << 14;
+	options.limit = 5000;
+	auto first = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(5000u, first.entries);
+	EXPECT_LT(1u, first.checkpoints);
+	EXPECT_TRUE(exists("batch.journal"));
+
+	// output written behind the last checkpoint by a crashed run
+	{
+		std::ofstream out("batch_out.txt", std::ios::binary | std::ios::app);
+		out << "12345";
+	}
+	options.limit = 0;
+	auto second = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(5000u, second.resumed);
+	EXPECT_EQ(entries - 5000, second.entries);
+	EXPECT_EQ(expected, readFile("batch_out.txt"));
+	EXPECT_FALSE(exists("batch.journal"));
+	std::remove("batch_in.txt");
+	std::remove("batch_out.txt");
+}
+
+TEST(BatchTest, ignoresJournalOfOtherInput) {
+	std::string expected;
+	writeArchive("batch_in.txt", expected);
+	BatchOptions options;
+	options.journal = "batch.journal";
+	options.limit = 100;
+	runBatch("batch_in.txt", "batch_out.txt", options);
+	{
+		std::fstream in("batch_in.txt", std::ios::binary | std::ios::in | std::ios::out);
+		in.seekp(1);
+		in.put(' ');
+	}
+	options.limit = 0;
+	auto stats = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(0u, stats.resumed);
+	EXPECT_EQ(entries, stats.entries);
+	std::remove("batch_in.txt");
+	std::remove("batch_out.txt");
+}
+
+TEST(BatchTest, ignoresJournalOfOtherRepairOptions) {
+	std::string expected;
+	writeArchive("batch_in.txt", expected);
+	BatchOptions options;
+	options.repair.checksum = &ChecksumScheme::getLuhn();
+	runBatch("batch_in.txt", "batch_luhn.txt", options);
+
+	options.repair.checksum = nullptr;
+	options.journal = "batch.journal";
+	options.limit = 5000;
+	runBatch("batch_in.txt", "batch_out.txt", options);
+	options.repair.checksum = &ChecksumScheme::getLuhn();
+	options.limit = 0;
+	auto stats = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(0u, stats.resumed);
+	EXPECT_EQ(entries, stats.entries);
+	EXPECT_EQ(readFile("batch_luhn.txt"), readFile("batch_out.txt"));
+	std::remove("batch_in.txt");
+	std::remove("batch_out.txt");
+	std::remove("batch_luhn.txt");
+}
+
+TEST(BatchTest, reusesCachedResults) {
+	std::string expected;
+	writeArchive("batch_in.txt", expected);
+	BatchOptions options;
+	options.cache = "batch.cache";
+	EXPECT_EQ(entries, runBatch("batch_in.txt", "batch_out.txt", options).entries);
+	Metrics metrics;
+	options.metrics = &metrics;
+
+	// resent unchanged
+	auto stats = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(0u, stats.entries);
+	EXPECT_EQ(entries, stats.reused);
+	EXPECT_EQ(expected, readFile("batch_out.txt"));
+
+	// resent with entries appended: the complete chunks of 4096 entries are reused
+	writeArchive("batch_in.txt", expected, entries + 500, true);
+	stats = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(8192u, stats.reused);
+	EXPECT_EQ(entries + 500 - 8192, stats.entries);
+	EXPECT_EQ(expected, readFile("batch_out.txt"));
+	EXPECT_EQ(2 * entries + 500, metrics.getCounters(0).entries.load());
+	EXPECT_EQ(entries + 8192, metrics.getCounters(0).cacheHits.load());
+	EXPECT_EQ(entries + 500 - 8192, metrics.getCounters(0).decoded.load());
+
+	// other repair options, or another tag of the caller
+	options.repair.checksum = &ChecksumScheme::getLuhn();
+	EXPECT_EQ(0u, runBatch("batch_in.txt", "batch_out.txt", options).reused);
+	EXPECT_EQ(entries + 500, runBatch("batch_in.txt", "batch_out.txt", options).reused);
+	options.cacheTag = 1;
+	EXPECT_EQ(0u, runBatch("batch_in.txt", "batch_out.txt", options).reused);
+	std::remove("batch_in.txt");
+	std::remove("batch_out.txt");
+	std::remove("batch.cache");
+}
+
+TEST(BatchTest, limitedRunLeavesNoCache) {
+	std::string expected;
+	writeArchive("batch_in.txt", expected);
+	std::remove("batch.cache");
+	BatchOptions options;
+	options.cache = "batch.cache";
+	options.limit = 5000;
+	EXPECT_EQ(5000u, runBatch("batch_in.txt", "batch_out.txt", options).entries);
+	EXPECT_FALSE(exists("batch.cache"));
+
+	options.limit = 0;
+	auto stats = runBatch("batch_in.txt", "batch_out.txt", options);
+	EXPECT_EQ(entries, stats.entries);
+	EXPECT_EQ(0u, stats.reused);
+	EXPECT_EQ(expected, readFile("batch_out.txt"));
+	EXPECT_EQ(entries, runBatch("batch_in.txt", "batch_out.txt", options).reused);
+	std::remove("batch_in.txt");
+	std::remove("batch_out.txt");
+	std::remove("batch.cache");
+}
@@ -0,0 +1,132 @@
+#include "Bitmap.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace {
+	const std::string entry =
+		"    _  _     _  _  _  _  _ "
+		"  | _| _||_||_ |_   ||_||_|"
+		"  ||_  _|  | _||_|  ||_| _|"
+		"                           ";
+
+	const std::string zeros =
+		" _  _  _  _  _  _  _  _  _ "
+		"| || || || || || || || || |"
+		"|_||_||_||_||_||_||_||_||_|"
+		"                           ";
+
+	// ascii art rendered with 6x6 pixels per character, blank margins left and right
+	std::vector<unsigned char> render(const std::string& text, int& width, int& height, int margin = 0, int rightMargin = 0) {
+		const int cell = 6;
+		width = 27 * cell + margin + rightMargin;
+		height = int(text.size() / 27) * cell;
+		std::vector<unsigned char> pixels(size_t(width) * height, 255);
+		for (size_t i = 0; i < text.size(); ++i) {
+			int x0 = margin + int(i % 27) * cell, y0 = int(i / 27) * cell;
+			for (int k = 0; k < cell; ++k) {
+				if (text[i] == '_') pixels[(y0 + cell - 1) * width + x0 + k] = 0;
+				if (text[i] == '|') pixels[(y0 + k) * width + x0 + 2] = pixels[(y0 + k) * width + x0 + 3] = 0;
+			}
+		}
+		return pixels;
+	}
+
+	std::string toPgm(const std::string& text) {
+		int w, h;
+		auto pixels = render(text, w, h);
+		std::ostringstream out;
+		out << "P5\n# rendered\n" << w << ' ' << h << "\n255\n";
+		out.write(reinterpret_cast<const char*>(pixels.data()), pixels.size());
+		return out.str();
+	}
+
+	std::string toPbm(const std::string& text) {
+		int w, h;
+		auto pixels = render(text, w, h);
+		std::ostringstream out;
+		out << "P4\n" << w << ' ' << h << "\n";
+		for (int y = 0; y < h; ++y) {
+			std::vector<char> row((w + 7) / 8);
+			for (int x = 0; x < w; ++x) {
+				if (!pixels[y * w + x]) row[x >> 3] |= char(0x80 >> (x & 7));
+			}
+			out.write(row.data(), row.size());
+		}
+		return out.str();
+	}
+}
+
+TEST(BitmapTest, readsPgm) {
+	std::istringstream in(toPgm(entry));
+	auto image = readBitmap(in);
+	EXPECT_EQ(162, image.width);
+	EXPECT_EQ(24, image.height);
+	auto bands = readBands(image);
+	ASSERT_EQ(1u, bands.size());
+	EXPECT_EQ(OCR::read(entry), bands[0]);
+}
+
+TEST(BitmapTest, masksMatchTextDecoder) {
+	std::istringstream in(toPbm(zeros + entry));
+	auto image = readBitmap(in);
+	auto bands = findBands(image);
+	ASSERT_EQ(2u, bands.size());
+	auto masks = getStrokeMasks(image, bands[1]);
+	for (int i = 0; i < 9; ++i) EXPECT_EQ(GlyphSet::getMask(entry.data() + 3 * i, 27), masks[i]);
+
+	auto digits = readBands(image);
+	EXPECT_EQ(std::vector<int>({ 0,0,0,0,0,0,0,0,0 }), digits[0]);
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,9 }), digits[1]);
+}
+
+TEST(BitmapTest, ignoresMargins) {
+	const std::string sevens =
+		" _  _  _  _  _  _  _  _  _ "
+		"  |  |  |  |  |  |  |  |  |"
+		"  |  |  |  |  |  |  |  |  |"
+		"                           ";
+	for (auto& text : { entry, zeros, sevens, zeros + entry }) {
+		Bitmap image;
+		image.pixels = render(text, image.width, image.height, 41, 97);
+		auto bands = readBands(image);
+		ASSERT_EQ(text.size() / 108, bands.size());
+		for (size_t b = 0; b < bands.size(); ++b) EXPECT_EQ(OCR::read(text.substr(108 * b, 108)), bands[b]);
+	}
+}
+
+TEST(BitmapTest, readsAsciiFormats) {
+	std::istringstream pbm("P1\n3 2\n0 1 0\n1 1 1\n");
+	auto image = readBitmap(pbm);
+	EXPECT_EQ(255, image.at(0, 0));
+	EXPECT_EQ(0, image.at(1, 0));
+
+	std::istringstream pgm("P2\n2 1\n15\n0 15\n");
+	image = readBitmap(pgm);
+	EXPECT_EQ(0, image.at(0, 0));
+	EXPECT_EQ(255, image.at(1, 0));
+
+	std::istringstream ppm("P6\n1 1\n255\n");
+	EXPECT_THROW(readBitmap(ppm), std::runtime_error);
+}
+
+TEST(BitmapTest, rejectsBrokenFiles) {
+	// ink 200 of maxval 100 would wrap to paper
+	std::istringstream sample(std::string("P5 2 1 100\n\xc8\x00", 13));
+	EXPECT_THROW(readBitmap(sample), std::runtime_error);
+	std::istringstream empty("P5 0 1 255\n");
+	EXPECT_THROW(readBitmap(empty), std::runtime_error);
+	std::istringstream negative("P2 -3 1 255\n0 0 0");
+	EXPECT_THROW(readBitmap(negative), std::runtime_error);
+	// a short file claiming more than the pixel limit, and one claiming more than it holds
+	std::istringstream huge("P4 100000 100000\n\xff");
+	EXPECT_THROW(readBitmap(huge), std::runtime_error);
+	std::istringstream claims("P4 16384 16384\n\xff");
+	EXPECT_THROW(readBitmap(claims), std::runtime_error);
+
+	std::istringstream in(toPgm(entry));
+	auto image = readBitmap(in);
+	RasterOptions options;
+	options.digits = 0;
+	EXPECT_THROW(getStrokeMasks(image, findBands(image)[0], options), std::invalid_argument);
+}
@@ -0,0 +1,54 @@
+#include "OCR.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(ChecksumTest, builtInSchemes) {
+	EXPECT_EQ(0, ChecksumScheme::getMod11().getCheckSum({ 3,4,5,8,8,2,8,6,5 }));
+	EXPECT_EQ(0, ChecksumScheme::getLuhn().getCheckSum({ 1,2,3,4,5,6,7,8,2 }));
+	EXPECT_NE(0, ChecksumScheme::getLuhn().getCheckSum({ 1,2,3,4,5,6,7,8,9 }));
+	EXPECT_EQ(0, ChecksumScheme::getMod97().getCheckSum({ 1,2,3,4,5,6,7,5,1 }));
+	EXPECT_NE(0, ChecksumScheme::getMod97().getCheckSum({ 1,2,3,4,5,6,7,8,9 }));
+	EXPECT_EQ(&ChecksumScheme::getLuhn(), ChecksumScheme::find("luhn"));
+	EXPECT_EQ(nullptr, ChecksumScheme::find("crc"));
+}
+
+TEST(ChecksumTest, batchAndDeltaMatchScalar) {
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> digit(0, 9);
+	const size_t count = 200;
+	std::vector<unsigned char> digits(9 * count);
+	for (auto& d : digits) d = (unsigned char)digit(rng);
+
+	for (auto name : { "mod11", "luhn", "mod97" }) {
+		auto& scheme = *ChecksumScheme::find(name);
+		std::vector<unsigned char> residues(count);
+		scheme.getCheckSums(digits.data(), count, residues.data());
+		for (size_t i = 0; i < count; ++i) {
+			std::vector<int> in(digits.begin() + 9 * i, digits.begin() + 9 * (i + 1));
+			ASSERT_EQ(scheme.getCheckSum(in), residues[i]) << name;
+
+			auto sum = scheme.getSum(in);
+			auto pos = int(i % 9), to = digit(rng);
+			auto delta = scheme.getDelta(pos, in[pos], to);
+			in[pos] = to;
+			ASSERT_EQ(scheme.getCheckSum(in), scheme.getResidue(sum + delta)) << name;
+		}
+	}
+}
+
+TEST(ChecksumTest, repairsWithSelectedScheme) {
+	RepairOptions options;
+	options.checksum = &ChecksumScheme::getLuhn();
+	EXPECT_EQ("123456782", getCheckPlus({ 1,2,3,4,5,6,7,8,2 }, options));
+	EXPECT_EQ("123456709 FIX", getCheckPlus({ 1,2,3,4,5,6,7,8,9 }, options));
+	EXPECT_EQ("123456719 ERR", getCheckPlus({ 1,2,3,4,5,6,7,1,9 }, options));
+	using t = std::vector<std::vector<int>>;
+	EXPECT_EQ(t({ { 1,2,3,4,5,6,7,0,9 } }), checkReplace({ 1,2,3,4,5,6,7,8,9 }, ChecksumScheme::getLuhn()));
+}
+
+TEST(ChecksumTest, policyInstantiation) {
+	using LuhnOCR = BasicOCR<KataFont, 9, Luhn<9>>;
+	EXPECT_EQ("123456782", LuhnOCR::getCheck({ 1,2,3,4,5,6,7,8,2 }));
+	EXPECT_EQ("123456709 FIX", LuhnOCR::getCheckPlus({ 1,2,3,4,5,6,7,8,9 }));
+}
@@ -0,0 +1,41 @@
+#include "OCR.h"
+#include "Confusion.h"
+
+#include <gtest/gtest.h>
+
+TEST(ConfusionTest, strokes) {
+	EXPECT_EQ(0x7f, OCR::getStrokes(8));
+	EXPECT_EQ(0x7f & ~0x04, OCR::getStrokes(0));
+	EXPECT_EQ(0x48, OCR::getStrokes(1));
+}
+
+TEST(ConfusionTest, uniformModelKeepsAmbiguity) {
+	ConfusionModel model;
+	RepairOptions options;
+	options.model = &model;
+	EXPECT_EQ("490067715 AMB", getCheckPlus({ 4,9,0,0,6,7,7,1,5 }, options));
+	EXPECT_EQ("664371485 FIX", getCheckPlus({ 6,6,4,3,7, 1,4,9,5 }, options));
+	EXPECT_EQ("123456789", getCheckPlus({ 1,2,3,4,5,6,7,8,9 }, options));
+	EXPECT_EQ("86110??36 ILL", getCheckPlus({ 8,6,1,1,0,-1,-1,3,6 }, options));
+}
+
+TEST(ConfusionTest, dominantCandidateFixes) {
+	// middle bars get lost often, a top bar is hardly ever added
+	ConfusionModel model({ { .001, .01, .01, .01, .01, .01, .01 } }, { { .01, .01, .3, .01, .01, .01, .01 } });
+	RepairOptions options;
+	options.model = &model;
+	EXPECT_LT(model.getRepairCost(0, 8), model.getRepairCost(7, 1));
+	EXPECT_EQ("490867715 FIX", getCheckPlus({ 4,9,0,0,6,7,7,1,5 }, options));
+}
+
+TEST(ConfusionTest, trainsFromCorrections) {
+	std::vector<Correction> corpus;
+	for (int i = 0; i < 50; ++i) corpus.push_back({ { 4,9,0,0,6,7,7,1,5 }, { 4,9,0,8,6,7,7,1,5 } });
+	auto model = trainConfusionModel(corpus);
+	EXPECT_GT(model.getDrop(2), 10 * model.getDrop(0));
+	EXPECT_GT(model.getDrop(2), 10 * model.getAdd(0));
+
+	auto loaded = ConfusionModel::parse(model.toString());
+	EXPECT_EQ(model.getRepairCost(0, 8), loaded.getRepairCost(0, 8));
+	EXPECT_THROW(ConfusionModel::parse("add 1"), std::invalid_argument);
+}
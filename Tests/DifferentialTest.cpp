@@ -0,0 +1,55 @@
+#include "Differential.h"
+#include "OCR.h"
+#include "Swar.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+
+// the fast mode; ocrtool difftest runs the soak for nightly builds
+TEST(DifferentialTest, enginesAgree) {
+	DifferentialOptions options;
+	options.entries = 20000;
+	auto report = runDifferential(options, getDifferentialEngines("differential_test.txt"));
+	EXPECT_FALSE(report.failed) << report.toString();
+	EXPECT_EQ(20000u, report.entries);
+}
+
+TEST(DifferentialTest, references) {
+	std::string entry =
+		"    _  _     _  _  _  _  _ "
+		"  | _| _||_||_ |_   ||_||_|"
+		"  ||_  _|  | _||_|  ||_| _|"
+		"                           ";
+	EXPECT_EQ("123456789", getReferenceDigits(entry));
+	EXPECT_EQ("123456789", getReferenceLine(entry));
+	EXPECT_EQ("valid", getReferenceValid(entry));
+	entry[0] = '_';
+	EXPECT_EQ("?23456789", getReferenceDigits(entry));
+	EXPECT_EQ("?23456789 ILL", getReferenceLine(entry));
+	EXPECT_EQ("invalid", getReferenceValid(entry));
+}
+
+TEST(DifferentialTest, minimisesMismatch) {
+	// reads every 7 as 1
+	DifferentialEngine broken = { "broken", [](const std::vector<std::string>& entries) {
+		std::vector<std::string> out;
+		for (auto& e : entries) {
+			auto digits = OCR::getDigits(readSwar(e));
+			std::replace(digits.begin(), digits.end(), '7', '1');
+			out.push_back(digits);
+		}
+		return out;
+	}, getReferenceDigits };
+	DifferentialOptions options;
+	options.entries = 1000;
+	auto report = runDifferential(options, { broken });
+	ASSERT_TRUE(report.failed);
+	EXPECT_EQ("broken", report.engine);
+	EXPECT_GT(1000u, report.entries);
+	// the strokes of one 7
+	EXPECT_EQ(3, std::count_if(report.input.begin(), report.input.end(), [](char c) { return c != ' '; }));
+	EXPECT_EQ(1, std::count(report.expected.begin(), report.expected.end(), '7'));
+	EXPECT_EQ(8, std::count(report.expected.begin(), report.expected.end(), '?'));
+	EXPECT_EQ(1, std::count(report.actual.begin(), report.actual.end(), '1'));
+	EXPECT_NE(std::string::npos, report.toString().find("mismatch in broken"));
+}
@@ -0,0 +1,64 @@
+#include "Drift.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+	const std::string rows[4] = {
+		"    _  _     _  _  _  _  _ ",
+		"  | _| _||_||_ |_   ||_||_|",
+		"  ||_  _|  | _||_|  ||_| _|",
+		"                           " };
+
+	// rows moved by shift columns, positive to the right
+	std::string getShifted(int shift0, int shift1, int shift2) {
+		int shift[3] = { shift0, shift1, shift2 };
+		std::string ret;
+		for (int r = 0; r < 4; ++r) {
+			auto s = r < 3 ? shift[r] : 0;
+			std::string row = s >= 0 ? std::string(s, ' ') + rows[r] : rows[r].substr(-s) + std::string(-s, ' ');
+			ret += row.substr(0, 27);
+		}
+		return ret;
+	}
+
+	const std::vector<int> expected = { 1,2,3,4,5,6,7,8,9 };
+}
+
+TEST(DriftTest, alignedEntryIsNotTouched) {
+	DriftStats stats;
+	EXPECT_EQ(expected, readRealigned(getShifted(0, 0, 0), stats));
+	EXPECT_EQ(1u, stats.entries);
+	EXPECT_EQ(0u, stats.entryShift[2] + stats.unresolved);
+}
+
+TEST(DriftTest, realignsShiftedEntry) {
+	DriftStats stats;
+	EXPECT_EQ(std::vector<int>({ -1,-1,-1,-1,-1,-1,-1,-1,-1 }), OCR::read(getShifted(1, 1, 1)));
+	// the right column of the 9 is cut off by the shift
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,-1 }), readRealigned(getShifted(1, 1, 1), stats));
+	EXPECT_EQ(expected, readRealigned(getShifted(-1, -1, -1), stats));
+	EXPECT_EQ(expected, readRealigned(getShifted(-1, -1, -1), stats));
+	EXPECT_EQ(1u, stats.entryShift[3]);
+	EXPECT_EQ(2u, stats.entryShift[1]);
+}
+
+TEST(DriftTest, realignsTwoColumns) {
+	DriftStats stats;
+	EXPECT_EQ(expected, readRealigned(getShifted(-2, -2, -2), stats));
+	EXPECT_EQ(1u, stats.entryShift[0]);
+}
+
+TEST(DriftTest, realignsSingleRow) {
+	DriftStats stats;
+	EXPECT_EQ(expected, readRealigned(getShifted(0, -1, 0), stats));
+	EXPECT_EQ(1u, stats.rowShift[1][1]);
+	EXPECT_EQ(0u, stats.rowShift[0][1] + stats.rowShift[2][1]);
+}
+
+TEST(DriftTest, illegibleWithoutDriftIsNotRetried) {
+	DriftStats stats;
+	auto input = getShifted(0, 0, 0);
+	input[27 + 2] = '_';
+	EXPECT_EQ(std::vector<int>({ -1,2,3,4,5,6,7,8,9 }), readRealigned(input, stats));
+	EXPECT_EQ(0u, stats.unresolved);
+}
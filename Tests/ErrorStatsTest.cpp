@@ -0,0 +1,41 @@
+#include "ErrorStats.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+	void add(ErrorStats& stats, const std::string& entry) {
+		auto digits = OCR::read(entry);
+		stats.add(entry, digits, getResult(digits));
+	}
+}
+
+TEST(ErrorStatsTest, countsFailures) {
+	ErrorStats stats;
+	add(stats, OCR::render({ 4,5,7,5,0,8,0,0,0 }));
+	add(stats, OCR::render({ 6,6,4,3,7,1,4,9,5 }));
+	auto entry = OCR::render({ 1,2,3,4,5,6,7,8,9 });
+	// middle stroke of the 4 at position 3 missing: 0x4a is no digit
+	entry[OCR::width + 10] = ' ';
+	// noise in the 9 at position 8
+	entry[25] = 'x';
+	add(stats, entry);
+
+	EXPECT_EQ(3u, stats.getEntries());
+	EXPECT_EQ(1u, stats.status[int(Status::ok)]);
+	EXPECT_EQ(1u, stats.status[int(Status::fix)]);
+	EXPECT_EQ(1u, stats.status[int(Status::ill)]);
+	EXPECT_EQ(1u, stats.illegible[3]);
+	EXPECT_EQ(1u, stats.illegible[8]);
+	EXPECT_EQ(1u, stats.noise);
+	EXPECT_EQ(1u, stats.masks[0x4a]);
+	EXPECT_EQ(1u, stats.fixes[9][8]);
+
+	ErrorStats total;
+	total.merge(stats);
+	total.merge(stats);
+	total.add(getResult({ 1,2,3,4,5,6,7,8,-1 }));
+	EXPECT_EQ(7u, total.getEntries());
+	EXPECT_EQ(3u, total.illegible[8]);
+	EXPECT_EQ("entries 7\nstatus OK 2 ERR 0 ILL 3 AMB 0 FIX 2 UNK 0\nillegible 0 0 0 2 0 0 0 0 3\nnoise 2\nmask 0x4a 2\nfix 9>8 2\n",
+		total.toString());
+}
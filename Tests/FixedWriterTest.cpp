@@ -0,0 +1,55 @@
+#include "FixedWriter.h"
+#include "Format.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+	std::vector<Result> makeResults(size_t count) {
+		std::vector<Result> ret;
+		for (size_t n = 0; n < count; ++n) {
+			std::vector<int> digits;
+			for (int p = 0; p < 9; ++p) digits.push_back(int((n * 7 + p * 3) % 11) - 1);
+			ret.push_back(getResult(digits));
+		}
+		return ret;
+	}
+
+	std::string readFile(const std::string& path) {
+		std::ifstream in(path, std::ios::binary);
+		std::ostringstream text;
+		text << in.rdbuf();
+		return text.str();
+	}
+}
+
+TEST(FixedWriterTest, formatFixed) {
+	std::vector<Result> results = { getResult({ 4,5,7,5,0,8,0,0,0 }), getResult({ 8,6,1,1,0,-1,-1,3,6 }) };
+	std::string out(2 * fixedRecord + 1, '#');
+	EXPECT_EQ(2 * fixedRecord, formatFixed(results.data(), 2, &out[0]));
+	EXPECT_EQ("457508000    \n86110??36 ILL\n#", out);
+}
+
+TEST(FixedWriterTest, recordsAtTheirOffsets) {
+	// several chunks per worker and a partial last one
+	auto results = makeResults(3 * 4096 + 77);
+	writeFixedResults("fixed_results.txt", results.data(), results.size(), 3);
+	auto text = readFile("fixed_results.txt");
+	std::remove("fixed_results.txt");
+
+	ASSERT_EQ(results.size() * fixedRecord, text.size());
+	std::vector<char> expected(results.size() * fixedRecord);
+	formatFixed(results.data(), results.size(), expected.data());
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), text.begin()));
+	std::vector<char> record(fixedRecord);
+	formatFixed(&results[5000], 1, record.data());
+	EXPECT_EQ(std::string(record.begin(), record.end()), text.substr(5000 * fixedRecord, fixedRecord));
+}
+
+TEST(FixedWriterTest, emptyFile) {
+	writeFixedResults("fixed_empty.txt", nullptr, 0, 2);
+	EXPECT_EQ("", readFile("fixed_empty.txt"));
+	std::remove("fixed_empty.txt");
+}
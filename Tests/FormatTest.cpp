@@ -0,0 +1,47 @@
+#include "Format.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+	const std::vector<std::vector<int>> accounts = {
+		{ 4,5,7,5,0,8,0,0,0 },
+		{ 6,6,4,3,7,1,4,9,5 },
+		{ 8,6,1,1,0,-1,-1,3,6 },
+		{ 4,9,0,0,6,7,7,1,5 },
+		{ 1,2,3,4,5,6,7,8,-1 },
+		{ 3,4,5,8,8,2,8,6,5 } };
+
+	std::string getExpected() {
+		std::string ret;
+		for (auto& a : accounts) ret += getCheckPlus(a) + "\n";
+		return ret;
+	}
+
+	std::vector<Result> getResults() {
+		std::vector<Result> ret;
+		for (auto& a : accounts) ret.push_back(getResult(a));
+		return ret;
+	}
+}
+
+TEST(FormatTest, resultStatus) {
+	EXPECT_EQ(Status::ok, getResult({ 4,5,7,5,0,8,0,0,0 }).status);
+	EXPECT_EQ(Status::fix, getResult({ 6,6,4,3,7,1,4,9,5 }).status);
+	EXPECT_EQ(8, getResult({ 6,6,4,3,7,1,4,9,5 }).digits[7]);
+	EXPECT_EQ(Result::illegible, getResult({ 8,6,1,1,0,-1,-1,3,6 }).digits[5]);
+	EXPECT_STREQ(" AMB", getStatusText(Status::amb));
+}
+
+TEST(FormatTest, matchesGetCheckPlus) {
+	auto results = getResults();
+	std::vector<char> out(getFormatSize(results.size()));
+	auto n = formatResults(results.data(), results.size(), out.data());
+	EXPECT_EQ(getExpected(), std::string(out.data(), n));
+}
+
+TEST(FormatTest, portableMatchesGetCheckPlus) {
+	auto results = getResults();
+	std::vector<char> out(getFormatSize(results.size()));
+	auto n = formatResultsPortable(results.data(), results.size(), out.data());
+	EXPECT_EQ(getExpected(), std::string(out.data(), n));
+}
@@ -0,0 +1,99 @@
+#include "OCR.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+	// kata font plus a 7 with a left stroke and a 9 without the bottom bar
+	const char* scannerFont =
+		"# scanner B\n"
+		"0123456789\n"
+		" _     _  _     _  _  _  _  _ \n"
+		"| |  | _| _||_||_ |_   ||_||_|\n"
+		"|_|  ||_  _|  | _||_|  ||_| _|\n"
+		"\n"
+		"7 9\n"
+		" _  _ \n"
+		"| ||_|\n"
+		"  |  |\n";
+}
+
+TEST(GlyphSetTest, kataFontMatchesGlyphs) {
+	auto& glyphs = OCR::getGlyphSet();
+	for (int d = 0; d < 10; ++d) {
+		ASSERT_EQ(1u, glyphs.getVariants(d).size());
+		EXPECT_EQ(d, glyphs.decode(KataFont::glyphs[d], 3));
+		EXPECT_EQ(OCR::getStrokes(d), glyphs.getVariants(d)[0]);
+	}
+	EXPECT_EQ(-1, glyphs.decode("|_||_||_|", 3));
+	EXPECT_EQ(-1, OCR::getNumber(" _ |_|  "));
+	// the kata's table, which has no neighbours for 6
+	for (int d = 0; d < 10; ++d) EXPECT_EQ(KataFont::replacements[d], glyphs.getReplacements(d));
+	EXPECT_EQ(std::vector<int>(), glyphs.getReplacements(6));
+	EXPECT_EQ(std::vector<int>({ 3, 5, 8 }), glyphs.getReplacements(9));
+
+	// compiled from text the neighbours are symmetric
+	auto parsed = GlyphSet::parse(std::string(scannerFont).substr(0, std::string(scannerFont).find("\n\n")));
+	EXPECT_EQ(std::vector<int>({ 5, 8 }), parsed.getReplacements(6));
+	EXPECT_EQ(std::vector<int>({ 3, 5, 8 }), parsed.getReplacements(9));
+}
+
+TEST(GlyphSetTest, kataGlyphSetRepairsAsTheKata) {
+	RepairOptions options;
+	options.glyphs = &OCR::getGlyphSet();
+	// 6 in the first place: a loaded kata font would also try 5 and 8 there
+	std::vector<int> in = { 6,6,4,3,7,1,4,9,5 };
+	EXPECT_EQ(getCheckPlus(in), getCheckPlus(in, options));
+	for (int n = 0; n < 100000; n += 7) {
+		std::vector<int> digits;
+		for (int p = 0, v = n * 7919; p < 9; ++p, v /= 3) digits.push_back((v + p * n) % 10);
+		EXPECT_EQ(getCheckPlus(digits), getCheckPlus(digits, options));
+	}
+}
+
+TEST(GlyphSetTest, loadsVariants) {
+	auto glyphs = GlyphSet::parse(scannerFont);
+	EXPECT_EQ(2u, glyphs.getVariants(7).size());
+	EXPECT_EQ(2u, glyphs.getVariants(9).size());
+
+	std::string variants =
+		" _  _ "
+		"| ||_|"
+		"  |  |";
+	EXPECT_EQ(7, glyphs.decode(variants.data(), 6));
+	EXPECT_EQ(9, glyphs.decode(variants.data() + 3, 6));
+	EXPECT_EQ(-1, OCR::getGlyphSet().decode(variants.data(), 6));
+}
+
+TEST(GlyphSetTest, readsWithLoadedFont) {
+	std::string input =
+		"    _  _     _  _  _  _  _ "
+		"  | _| _||_||_ |_ | ||_||_|"
+		"  ||_  _|  | _||_|  ||_|  |"
+		"                           ";
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,-1,8,-1 }), OCR::read(input));
+	auto glyphs = GlyphSet::parse(scannerFont);
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,9 }), OCR::read(input, glyphs));
+}
+
+TEST(GlyphSetTest, rejectsCollisions) {
+	EXPECT_THROW(GlyphSet::parse("17\n      \n  |  |\n  |  |\n"), std::invalid_argument);
+	EXPECT_THROW(GlyphSet::parse("1\n |  \n  |\n  |\n"), std::invalid_argument);
+	EXPECT_THROW(GlyphSet::parse("x\n"), std::invalid_argument);
+}
+
+TEST(GlyphSetTest, toleratesScannerNoise) {
+	std::string input =
+		"    _  _     _  _ ._  _  _ "
+		"  ! _| _||_|l_ |_   ||_||_|"
+		"  I|_  _|  | _||_|  ||_| _|"
+		"                           ";
+	input[9] = '\0';
+	input[2 * 27 + 18] = '\t';
+	EXPECT_EQ(std::vector<int>({ -1,2,3,-1,-1,6,-1,8,9 }), OCR::read(input));
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,9 }), OCR::read(input, OCR::getGlyphSet(), ByteClasses::getTolerant()));
+
+	ByteClasses classes;
+	classes.set("#", ByteClasses::pipe);
+	EXPECT_EQ(1, OCR::getGlyphSet().decode("     #  #", 3, classes));
+	EXPECT_EQ(-1, OCR::getGlyphSet().decode("     #  #", 3));
+}
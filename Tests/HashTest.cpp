@@ -0,0 +1,19 @@
+#include "Hash.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(HashTest, referenceValues) {
+	EXPECT_EQ(0xEF46DB3751D8E999ull, getHash("", 0));
+	EXPECT_EQ(0xD24EC4F1A98C6E5Bull, getHash("a", 1));
+	EXPECT_EQ(0x44BC2CF5AD770999ull, getHash("abc", 3));
+}
+
+TEST(HashTest, longInput) {
+	std::string text(1000, 'x');
+	auto h = getHash(text.data(), text.size());
+	EXPECT_EQ(h, getHash(text.data(), text.size()));
+	text[999] = 'y';
+	EXPECT_NE(h, getHash(text.data(), text.size()));
+	EXPECT_NE(h, getHash(text.data(), text.size(), 1));
+}
@@ -0,0 +1,133 @@
+#include "OCR.h"
+#include "KnownAccounts.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace {
+	std::vector<uint32_t> openAccounts() {
+		std::vector<uint32_t> ret = { 490867715, 123456789, 999999999 };
+		// dense chunk, stored as bitmap
+		for (uint32_t a = 0; a < 10000; ++a) ret.push_back(345000000 + 2 * a);
+		return ret;
+	}
+
+	void checkLookups(const KnownAccounts& known) {
+		EXPECT_TRUE(known.contains(490867715u));
+		EXPECT_TRUE(known.contains(999999999u));
+		EXPECT_TRUE(known.contains(345000000u + 2 * 9999));
+		EXPECT_FALSE(known.contains(345000001u));
+		EXPECT_FALSE(known.contains(490067115u));
+		EXPECT_FALSE(known.contains(0u));
+		EXPECT_TRUE(known.contains(std::vector<int>({ 1,2,3,4,5,6,7,8,9 })));
+		EXPECT_FALSE(known.contains(std::vector<int>({ 1,2,3,4,5,6,7,8,-1 })));
+	}
+}
+
+TEST(KnownAccountsTest, compressedLookup) {
+	writeKnownAccounts("known_compressed.bin", openAccounts(), true);
+	{
+		KnownAccounts known("known_compressed.bin");
+		EXPECT_TRUE(known.isCompressed());
+		checkLookups(known);
+	}
+	std::remove("known_compressed.bin");
+}
+
+// the plain bitset is 125 MB, written sparse: the header and the bytes holding open
+// accounts, the rest is a hole that takes no disk space where supported
+TEST(KnownAccountsTest, bitsetLookup) {
+	std::map<uint32_t, unsigned char> bytes;
+	for (auto a : openAccounts()) bytes[a >> 3] |= (unsigned char)(1 << (a & 7));
+	{
+		std::ofstream out("known_bitset.bin", std::ios::binary);
+		out.write("BKOCRBIT", 8);
+		out << std::string(8, '\0');
+		// 999999999 is in the last byte, so the file ends at its full size
+		for (auto& b : bytes) {
+			out.seekp(16 + b.first);
+			out.put(char(b.second));
+		}
+	}
+	{
+		KnownAccounts known("known_bitset.bin");
+		EXPECT_FALSE(known.isCompressed());
+		checkLookups(known);
+		for (auto a : { 490867715u, 123456789u, 999999999u }) {
+			EXPECT_TRUE(known.contains(a));
+			EXPECT_FALSE(known.contains(a - 1));
+			EXPECT_FALSE(known.contains(a + 1));
+		}
+	}
+	std::remove("known_bitset.bin");
+}
+
+// without the bits behind the header
+TEST(KnownAccountsTest, rejectsTruncatedBitset) {
+	{
+		std::ofstream out("known_bitset.bin", std::ios::binary);
+		out.write("BKOCRBIT", 8);
+		out << std::string(8 + 4096, '\0');
+	}
+	EXPECT_THROW(KnownAccounts("known_bitset.bin"), std::runtime_error);
+	std::remove("known_bitset.bin");
+}
+
+TEST(KnownAccountsTest, rejectsCorruptDirectory) {
+	writeKnownAccounts("known_corrupt.bin", openAccounts(), true);
+	std::string file;
+	{
+		std::ifstream in("known_corrupt.bin", std::ios::binary);
+		std::ostringstream text;
+		text << in.rdbuf();
+		file = text.str();
+	}
+	auto write = [](const std::string& data) {
+		std::ofstream out("known_corrupt.bin", std::ios::binary | std::ios::trunc);
+		out << data;
+	};
+
+	// the last chunk cut short
+	write(file.substr(0, file.size() - 2));
+	EXPECT_THROW(KnownAccounts("known_corrupt.bin"), std::runtime_error);
+
+	// the chunk of 490867715 pointing past the end
+	auto corrupt = file;
+	uint32_t offset = 0x7fffffff;
+	std::memcpy(&corrupt[16 + 8 * (490867715 >> 16)], &offset, 4);
+	write(corrupt);
+	EXPECT_THROW(KnownAccounts("known_corrupt.bin"), std::runtime_error);
+
+	// a count beyond a chunk
+	corrupt = file;
+	uint32_t count = 70000;
+	std::memcpy(&corrupt[16 + 8 * (123456789 >> 16) + 4], &count, 4);
+	write(corrupt);
+	EXPECT_THROW(KnownAccounts("known_corrupt.bin"), std::runtime_error);
+
+	write(file);
+	EXPECT_NO_THROW(KnownAccounts("known_corrupt.bin"));
+	std::remove("known_corrupt.bin");
+}
+
+TEST(KnownAccountsTest, disambiguatesRepairs) {
+	writeKnownAccounts("known_repair.bin", openAccounts(), true);
+	{
+		KnownAccounts known("known_repair.bin");
+		RepairOptions options;
+		options.known = &known;
+		EXPECT_EQ("490867715 FIX", getCheckPlus({ 4,9,0,0,6,7,7,1,5 }, options));
+		EXPECT_EQ("123456789", getCheckPlus({ 1,2,3,4,5,6,7,8,9 }, options));
+		EXPECT_EQ("457508000 UNK", getCheckPlus({ 4,5,7,5,0,8,0,0,0 }, options));
+		EXPECT_EQ("664371495 ERR", getCheckPlus({ 6,6,4,3,7,1,4,9,5 }, options));
+	}
+	std::remove("known_repair.bin");
+}
+
+TEST(KnownAccountsTest, rejectsOtherFiles) {
+	EXPECT_THROW(KnownAccounts("does_not_exist.bin"), std::runtime_error);
+}
@@ -0,0 +1,59 @@
+#include "Latency.h"
+
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(LatencyTest, buckets) {
+	EXPECT_EQ(0, LatencyHistogram::getBucket(0));
+	EXPECT_EQ(15, LatencyHistogram::getBucket(15));
+	EXPECT_EQ(16, LatencyHistogram::getBucket(16));
+	EXPECT_EQ(LatencyHistogram::buckets - 1, LatencyHistogram::getBucket(~uint64_t(0)));
+	EXPECT_EQ(~uint64_t(0), LatencyHistogram::getUpperBound(LatencyHistogram::buckets - 1));
+	for (uint64_t v = 1; v < (uint64_t(1) << 40); v = v * 3 + 1) {
+		auto b = LatencyHistogram::getBucket(v);
+		EXPECT_LE(v, LatencyHistogram::getUpperBound(b));
+		EXPECT_GT(v, b ? LatencyHistogram::getUpperBound(b - 1) : 0);
+	}
+}
+
+TEST(LatencyTest, percentiles) {
+	LatencyHistogram h;
+	EXPECT_EQ(0u, h.getPercentile(0.5));
+	for (uint64_t v = 1; v <= 10000; ++v) h.record(v);
+	EXPECT_EQ(10000u, h.getCount());
+	auto p50 = h.getPercentile(0.5);
+	EXPECT_LE(5000u, p50);
+	EXPECT_GE(5000u * 17 / 16, p50);
+	auto p999 = h.getPercentile(0.999);
+	EXPECT_LE(9990u, p999);
+	EXPECT_GE(9990u * 17 / 16, p999);
+	EXPECT_LE(10000u, h.getPercentile(1));
+}
+
+TEST(LatencyTest, mergeWhileRecording) {
+	LatencyHistogram worker, total;
+	std::thread t([&] {
+		for (int i = 0; i < 100000; ++i) worker.record(100);
+	});
+	for (int i = 0; i < 10; ++i) {
+		LatencyHistogram snapshot;
+		snapshot.merge(worker);
+		EXPECT_GE(100000u, snapshot.getCount());
+	}
+	t.join();
+	total.merge(worker);
+	total.merge(worker);
+	EXPECT_EQ(200000u, total.getCount());
+	EXPECT_EQ(200000u, total.getCount(LatencyHistogram::getBucket(100)));
+}
+
+TEST(LatencyTest, stageReport) {
+	StageLatency latency;
+	auto start = getTicks();
+	latency[Stage::read].record(getTicks() - start);
+	EXPECT_LT(0, getTicksPerSecond());
+	auto text = latency.toString();
+	EXPECT_NE(std::string::npos, text.find("frame count 0\n"));
+	EXPECT_NE(std::string::npos, text.find("validate count 0\nrepair count 0\n"));
+	EXPECT_NE(std::string::npos, text.find("read count 1 p50 "));
+}
@@ -0,0 +1,75 @@
+#include "Metrics.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	Metrics makeMetrics() {
+		Metrics metrics(2);
+		WorkerCounters::add(metrics.getCounters(0).entries, 10);
+		WorkerCounters::add(metrics.getCounters(1).entries, 5);
+		WorkerCounters::add(metrics.getCounters(1).status[int(Status::amb)], 3);
+		metrics.getLatency(0)[Stage::read].record(1);
+		metrics.getLatency(1)[Stage::read].record(~uint64_t(0) >> 1);
+		return metrics;
+	}
+
+	std::string readFile(const std::string& path) {
+		std::ifstream in(path, std::ios::binary);
+		std::ostringstream text;
+		text << in.rdbuf();
+		return text.str();
+	}
+}
+
+TEST(MetricsTest, aggregatesWorkers) {
+	auto text = makeMetrics().toPrometheus();
+	EXPECT_NE(std::string::npos, text.find("# TYPE bankocr_entries_total counter\nbankocr_entries_total 15\n"));
+	EXPECT_NE(std::string::npos, text.find("bankocr_status_total{status=\"amb\"} 3\n"));
+	EXPECT_NE(std::string::npos, text.find("# TYPE bankocr_stage_seconds histogram\n"));
+	EXPECT_NE(std::string::npos, text.find("# HELP bankocr_stage_seconds Time per stage of one entry in BatchOptions::latencySample"));
+	EXPECT_NE(std::string::npos, text.find("bankocr_stage_seconds_bucket{stage=\"read\",le=\"1e-07\"} 1\n"));
+	EXPECT_NE(std::string::npos, text.find("bankocr_stage_seconds_bucket{stage=\"read\",le=\"1\"} 1\n"));
+	EXPECT_NE(std::string::npos, text.find("bankocr_stage_seconds_bucket{stage=\"read\",le=\"+Inf\"} 2\n"));
+	EXPECT_NE(std::string::npos, text.find("bankocr_stage_seconds_count{stage=\"frame\"} 0\n"));
+}
+
+TEST(MetricsTest, fileReplaced) {
+	auto metrics = makeMetrics();
+	{
+		MetricsFileWriter writer("metrics.prom", metrics, std::chrono::milliseconds(20));
+		std::this_thread::sleep_for(std::chrono::milliseconds(60));
+		WorkerCounters::add(metrics.getCounters(0).entries, 1);
+	}
+	EXPECT_NE(std::string::npos, readFile("metrics.prom").find("bankocr_entries_total 16\n"));
+	EXPECT_FALSE(std::ifstream("metrics.prom.tmp"));
+	std::remove("metrics.prom");
+}
+
+#ifndef _WIN32
+TEST(MetricsTest, servedOnSocket) {
+	auto metrics = makeMetrics();
+	MetricsServer server("metrics_test.sock", metrics);
+	auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	std::snprintf(address.sun_path, sizeof(address.sun_path), "metrics_test.sock");
+	ASSERT_EQ(0, connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+	const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+	ASSERT_EQ(ssize_t(request.size()), send(fd, request.data(), request.size(), 0));
+	std::string response;
+	char buffer[4096];
+	for (ssize_t n; (n = recv(fd, buffer, sizeof(buffer), 0)) > 0;) response.append(buffer, size_t(n));
+	close(fd);
+	EXPECT_EQ(0u, response.find("HTTP/1.0 200 OK\r\n"));
+	EXPECT_NE(std::string::npos, response.find("bankocr_entries_total 15\n"));
+}
+#endif
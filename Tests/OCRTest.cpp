@@ -14,6 +14,16 @@ TEST(OCRTest, readsValidInput) {
 	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,9 }), ret);
 }
 
+TEST(OCRTest, rendersInput) {
+	const std::string input =
+		"    _  _     _  _  _  _  _ "
+		"  | _| _||_||_ |_   ||_||_|"
+		"  ||_  _|  | _||_|  ||_| _|"
+		"                           ";
+	EXPECT_EQ(input, OCR::render({ 1,2,3,4,5,6,7,8,9 }));
+	EXPECT_EQ(std::vector<int>({ 0,9,8,7,6,5,4,3,2 }), OCR::read(OCR::render({ 0,9,8,7,6,5,4,3,2 })));
+}
+
 TEST(OCRTest, checkChecksum) {
 	std::vector<int> ret = { 3,4,5,8,8,2,8,6,5 };
 	auto chsu = getCheckSum(ret);
@@ -38,3 +48,16 @@ TEST(OCRTest, checkPlus) {
 	EXPECT_EQ("86110??36 ILL", getCheckPlus({ 8,6,1,1,0,-1,-1,3,6 }));
 	EXPECT_EQ("664371485 FIX", getCheckPlus({ 6,6,4,3,7, 1,4,9,5 }));
 }
+
+TEST(OCRTest, validateThenRepair) {
+	const std::vector<std::vector<int>> accounts = {
+		{ 1,2,3,4,5,6,7,8,9 }, { 8,6,1,1,0,-1,-1,3,6 }, { 4,9,0,0,6,7,7,1,5 }, { 6,6,4,3,7,1,4,9,5 }, { 1,1,1,1,1,1,1,1,2 } };
+	const Status validated[] = { Status::ok, Status::ill, Status::err, Status::err, Status::err };
+	for (size_t i = 0; i < accounts.size(); ++i) {
+		EXPECT_EQ(validated[i], validate(accounts[i]));
+		auto result = getResult(accounts[i], RepairOptions(), validated[i]);
+		auto expected = getResult(accounts[i]);
+		EXPECT_EQ(expected.status, result.status);
+		EXPECT_TRUE(std::equal(expected.digits, expected.digits + 9, result.digits));
+	}
+}
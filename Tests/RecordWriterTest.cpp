@@ -0,0 +1,55 @@
+#include "RecordWriter.h"
+#include "ResultColumns.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+	const uint32_t candidates[] = { 490067115, 490067719, 490867715 };
+}
+
+TEST(RecordWriterTest, jsonLines) {
+	std::ostringstream out;
+	{
+		JsonLinesWriter writer(out);
+		writer.write(getResult({ 4,5,7,5,0,8,0,0,0 }), 0);
+		writer.write(getResult({ 8,6,1,1,0,-1,-1,3,6 }), ResultColumns::noOffset);
+		writer.write(getResult({ 4,9,0,0,6,7,7,1,5 }), 224, candidates, 3);
+	}
+	EXPECT_EQ(
+		"{\"offset\":0,\"account\":\"457508000\",\"status\":\"OK\",\"candidates\":[]}\n"
+		"{\"offset\":null,\"account\":\"86110??36\",\"status\":\"ILL\",\"candidates\":[]}\n"
+		"{\"offset\":224,\"account\":\"490067715\",\"status\":\"AMB\",\"candidates\":[\"490067115\",\"490067719\",\"490867715\"]}\n",
+		out.str());
+}
+
+TEST(RecordWriterTest, csv) {
+	std::ostringstream out;
+	{
+		CsvWriter writer(out);
+		writer.write(getResult({ 6,6,4,3,7,1,4,9,5 }), 18446744073709551614ull);
+		writer.write(getResult({ 4,9,0,0,6,7,7,1,5 }), ResultColumns::noOffset, candidates, 2);
+	}
+	EXPECT_EQ(
+		"offset,account,status,candidates\n"
+		"18446744073709551614,664371485,FIX,\n"
+		",490067715,AMB,490067115;490067719\n",
+		out.str());
+}
+
+TEST(RecordWriterTest, smallBufferFlushes) {
+	std::ostringstream small, large;
+	{
+		JsonLinesWriter a(small, 16), b(large);
+		for (int i = 0; i < 100; ++i) {
+			auto result = getResult({ 4,9,0,0,6,7,7,1,5 });
+			a.write(result, i, candidates, 3);
+			b.write(result, i, candidates, 3);
+		}
+		a.flush();
+		auto text = small.str();
+		EXPECT_EQ(100, std::count(text.begin(), text.end(), '\n'));
+	}
+	EXPECT_EQ(large.str(), small.str());
+}
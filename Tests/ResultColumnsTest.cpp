@@ -0,0 +1,113 @@
+#include "ResultColumns.h"
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+TEST(ResultColumnsTest, candidates) {
+	auto candidates = getCandidates({ 4,9,0,0,6,7,7,1,5 });
+	ASSERT_EQ(3u, candidates.size());
+	EXPECT_EQ(490067115u, getAccountNumber(candidates[0]));
+	EXPECT_EQ(490067719u, getAccountNumber(candidates[1]));
+	EXPECT_EQ(490867715u, getAccountNumber(candidates[2]));
+	EXPECT_TRUE(getCandidates({ 8,6,1,1,0,-1,-1,3,6 }).empty());
+}
+
+TEST(ResultColumnsTest, writeAndMap) {
+	ResultColumnsWriter writer;
+	writer.addDecoded({ 4,5,7,5,0,8,0,0,0 }, 0);
+	writer.addDecoded({ 8,6,1,1,0,-1,-1,3,6 }, 112);
+	writer.addDecoded({ 4,9,0,0,6,7,7,1,5 }, 224);
+	writer.addDecoded({ 6,6,4,3,7,1,4,9,5 }, 336);
+	writer.write("results.col");
+	{
+		ResultColumns columns("results.col");
+		ASSERT_EQ(4u, columns.size());
+		EXPECT_EQ(457508000u, columns.getAccount(0));
+		EXPECT_EQ(Status::ok, columns.getStatus(0));
+		EXPECT_EQ(112u, columns.getOffset(1));
+		EXPECT_EQ(Status::ill, columns.getStatus(1));
+		EXPECT_EQ(0x60, columns.getIllegible(1));
+		EXPECT_EQ(Result::illegible, columns.getResult(1).digits[5]);
+		EXPECT_EQ(Status::amb, columns.getStatus(2));
+		ASSERT_EQ(3u, columns.getCandidateCount(2));
+		EXPECT_EQ(490067719u, columns.getCandidates(2)[1]);
+		EXPECT_EQ(0u, columns.getCandidateCount(3));
+		EXPECT_EQ(664371485u, columns.getAccount(3));
+		EXPECT_EQ(Status::fix, columns.getStatus(3));
+
+		std::ostringstream text;
+		writeResultText(columns, text);
+		EXPECT_EQ("457508000\n86110??36 ILL\n490067715 AMB ['490067115', '490067719', '490867715']\n664371485 FIX\n", text.str());
+	}
+	std::remove("results.col");
+}
+
+TEST(ResultColumnsTest, textRoundTrip) {
+	const std::string text = "000000051\n49006771? ILL\n888888888 AMB ['888886888', '888888880', '888888988']\n111111111 ERR\n";
+	std::istringstream in(text);
+	readResultText(in).write("roundtrip.col");
+	{
+		ResultColumns columns("roundtrip.col");
+		EXPECT_EQ(ResultColumns::noOffset, columns.getOffset(0));
+		std::ostringstream out;
+		writeResultText(columns, out);
+		EXPECT_EQ(text, out.str());
+	}
+	std::remove("roundtrip.col");
+
+	std::istringstream bad("12345678 ERR\n");
+	EXPECT_THROW(readResultText(bad), std::invalid_argument);
+	std::istringstream badStatus("123456789 XYZ\n");
+	EXPECT_THROW(readResultText(badStatus), std::invalid_argument);
+}
+
+TEST(ResultColumnsTest, empty) {
+	ResultColumnsWriter().write("empty.col");
+	{
+		ResultColumns columns("empty.col");
+		EXPECT_EQ(0u, columns.size());
+	}
+	std::remove("empty.col");
+}
+
+TEST(ResultColumnsTest, rejectsCorruptFile) {
+	ResultColumnsWriter writer;
+	writer.addDecoded({ 4,5,7,5,0,8,0,0,0 }, 0);
+	writer.addDecoded({ 8,6,1,1,0,-1,-1,3,6 }, 112);
+	writer.addDecoded({ 4,9,0,0,6,7,7,1,5 }, 224);
+	writer.addDecoded({ 6,6,4,3,7,1,4,9,5 }, 336);
+	std::ostringstream text;
+	writer.write(text);
+	const auto file = text.str();
+	auto write = [](const std::string& data) {
+		std::ofstream out("corrupt.col", std::ios::binary | std::ios::trunc);
+		out << data;
+	};
+	// 4 entries and 3 candidates: firsts at byte 80, status at 128
+	auto corrupt = [&](size_t at, uint64_t value, size_t size) {
+		auto ret = file;
+		std::memcpy(&ret[at], &value, size);
+		return ret;
+	};
+
+	// counts whose layout wraps around
+	write(corrupt(8, uint64_t(1) << 61, 8));
+	EXPECT_THROW(ResultColumns("corrupt.col"), std::runtime_error);
+	write(corrupt(16, uint64_t(1) << 62, 8));
+	EXPECT_THROW(ResultColumns("corrupt.col"), std::runtime_error);
+
+	// firsts going down, so a candidate count would underflow
+	write(corrupt(80 + 4, 2, 4));
+	EXPECT_THROW(ResultColumns("corrupt.col"), std::runtime_error);
+
+	// a status past UNK
+	write(corrupt(128, 6, 1));
+	EXPECT_THROW(ResultColumns("corrupt.col"), std::runtime_error);
+
+	write(file);
+	EXPECT_NO_THROW(ResultColumns("corrupt.col"));
+	std::remove("corrupt.col");
+}
@@ -0,0 +1,36 @@
+#include "Sliced.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(SlicedTest, readsBatch) {
+	std::vector<std::string> entries = { OCR::render({ 1,2,3,4,5,6,7,8,9 }), OCR::render({ 3,4,5,8,8,2,8,6,5 }) };
+	entries[0][27] = 'x';
+	std::vector<bool> valid;
+	auto digits = readSliced(entries, &valid);
+	ASSERT_EQ(2u, digits.size());
+	EXPECT_EQ(std::vector<int>({ -1,2,3,4,5,6,7,8,9 }), digits[0]);
+	EXPECT_EQ(std::vector<int>({ 3,4,5,8,8,2,8,6,5 }), digits[1]);
+	EXPECT_FALSE(valid[0]);
+	EXPECT_TRUE(valid[1]);
+}
+
+TEST(SlicedTest, matchesScalarDecoder) {
+	std::mt19937 rng(11);
+	std::uniform_int_distribution<int> digit(0, 9), byte(0, 255);
+	std::vector<std::string> entries;
+	for (int n = 0; n < 1000; ++n) {
+		std::vector<int> digits(9);
+		for (auto& d : digits) d = digit(rng);
+		entries.push_back(OCR::render(digits));
+		if (n % 3 == 0) entries.back()[byte(rng) % 81] = " |_x"[byte(rng) % 4];
+	}
+	std::vector<bool> valid;
+	auto digits = readSliced(entries, &valid);
+	for (size_t n = 0; n < entries.size(); ++n) {
+		auto expected = OCR::read(entries[n]);
+		ASSERT_EQ(expected, digits[n]);
+		auto legible = std::find(expected.begin(), expected.end(), -1) == expected.end();
+		ASSERT_EQ(legible && 0 == getCheckSum(expected), valid[n]);
+	}
+}
@@ -0,0 +1,30 @@
+#include "Swar.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(SwarTest, readsValidInput) {
+	std::string input =
+		"    _  _     _  _  _  _  _ "
+		"  | _| _||_||_ |_   ||_||_|"
+		"  ||_  _|  | _||_|  ||_| _|"
+		"                           ";
+	EXPECT_EQ(std::vector<int>({ 1,2,3,4,5,6,7,8,9 }), readSwar(input));
+}
+
+TEST(SwarTest, matchesTableDecoder) {
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<int> digit(0, 9), noise(0, 40), byte(0, 255);
+	const char strokes[] = " |_";
+	for (int n = 0; n < 20000; ++n) {
+		std::vector<int> digits(9);
+		for (auto& d : digits) d = digit(rng);
+		auto input = OCR::render(digits);
+		// flip some bytes to other strokes or arbitrary values
+		for (int k = noise(rng) % 4; k > 0; --k) {
+			auto& c = input[byte(rng) % (3 * 27)];
+			c = byte(rng) < 200 ? strokes[byte(rng) % 3] : char(byte(rng));
+		}
+		ASSERT_EQ(OCR::read(input), readSwar(input)) << input;
+	}
+}
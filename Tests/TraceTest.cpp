@@ -0,0 +1,104 @@
+#include "Trace.h"
+#include "FixedWriter.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace {
+	std::string toJson(const Tracer& tracer) {
+		std::ostringstream out;
+		tracer.write(out);
+		return out.str();
+	}
+
+	size_t count(const std::string& text, const std::string& part) {
+		size_t n = 0;
+		for (auto p = text.find(part); p != std::string::npos; p = text.find(part, p + 1)) ++n;
+		return n;
+	}
+}
+
+TEST(TraceTest, spansPerThread) {
+	Tracer tracer;
+	tracer.setThreadName("main \"thread\"");
+	{
+		TraceSpan span(&tracer, "outer", "test", 7);
+		auto start = getTicks();
+		tracer.span("inner", "test", start, start + 10);
+	}
+	std::thread([&] {
+		TraceSpan span(&tracer, "worker", "test");
+		tracer.counter("queue", 3);
+	}).join();
+	EXPECT_EQ(4u, tracer.getEvents());
+
+	auto json = toJson(tracer);
+	EXPECT_EQ(0u, json.find("{\"traceEvents\":["));
+	EXPECT_NE(std::string::npos, json.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main \\\"thread\\\"\"}}"));
+	EXPECT_NE(std::string::npos, json.find("{\"name\":\"outer\",\"cat\":\"test\",\"ph\":\"X\",\"ts\":"));
+	EXPECT_NE(std::string::npos, json.find(",\"pid\":1,\"tid\":1,\"args\":{\"value\":7}}"));
+	EXPECT_NE(std::string::npos, json.find("{\"name\":\"worker\",\"cat\":\"test\",\"ph\":\"X\""));
+	EXPECT_NE(std::string::npos, json.find("{\"name\":\"queue\",\"ph\":\"C\",\"ts\":"));
+	EXPECT_NE(std::string::npos, json.find(",\"pid\":1,\"tid\":2,\"args\":{\"value\":3}}"));
+	EXPECT_NE(std::string::npos, json.find("],\"displayTimeUnit\":\"ns\"}"));
+}
+
+TEST(TraceTest, ringKeepsNewest) {
+	Tracer tracer(4);
+	for (int i = 0; i < 10; ++i) tracer.span("step", "test", getTicks(), getTicks(), i);
+	EXPECT_EQ(4u, tracer.getEvents());
+	auto json = toJson(tracer);
+	EXPECT_EQ(4u, count(json, "\"name\":\"step\""));
+	EXPECT_NE(std::string::npos, json.find("{\"value\":6}"));
+	EXPECT_NE(std::string::npos, json.find("{\"value\":9}"));
+	EXPECT_EQ(std::string::npos, json.find("{\"value\":5}"));
+}
+
+TEST(TraceTest, disabled) {
+	// a span without a tracer records nothing, not even on another tracer of the thread
+	Tracer tracer;
+	{
+		TraceSpan span(&tracer, "something", "test");
+	}
+	auto events = tracer.getEvents();
+	EXPECT_EQ(1u, events);
+	{
+		TraceSpan span(nullptr, "nothing", "test");
+		span.setValue(1);
+	}
+	EXPECT_EQ(events, tracer.getEvents());
+	EXPECT_EQ(std::string::npos, toJson(tracer).find("nothing"));
+}
+
+TEST(TraceTest, parallelWriter) {
+	std::vector<Result> results(10000, Result());
+	Tracer tracer;
+	writeFixedResults("trace_fixed.txt", results.data(), results.size(), 2, &tracer);
+	auto json = toJson(tracer);
+	EXPECT_EQ(3u, count(json, "\"name\":\"format\""));
+	EXPECT_EQ(3u, count(json, "\"name\":\"write\""));
+	EXPECT_EQ(3u, count(json, "\"name\":\"pending chunks\""));
+	EXPECT_NE(std::string::npos, json.find("\"args\":{\"name\":\"fixed writer 0\"}"));
+	std::remove("trace_fixed.txt");
+}
+
+TEST(TraceTest, dumpsOnSignal) {
+	Tracer tracer;
+	tracer.span("before", "test", getTicks(), getTicks());
+	std::remove("trace_signal.json");
+	{
+		TraceDumper dumper("trace_signal.json", tracer);
+		std::raise(traceSignal);
+		for (int i = 0; i < 100 && !std::ifstream("trace_signal.json"); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	std::ifstream in("trace_signal.json");
+	std::ostringstream text;
+	text << in.rdbuf();
+	EXPECT_NE(std::string::npos, text.str().find("\"name\":\"before\""));
+	in.close();
+	std::remove("trace_signal.json");
+}
@@ -0,0 +1,234 @@
+#include "OCR.h"
+#include "Archive.h"
+#include "Batch.h"
+#include "Bitmap.h"
+#include "Confusion.h"
+#include "Differential.h"
+#include "KnownAccounts.h"
+#include "ResultColumns.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+	std::vector<int> parseDigits(const std::string& str) {
+		std::vector<int> ret;
+		for (auto ch : str) ret.push_back(ch >= '0' && ch <= '9' ? ch - '0' : -1);
+		return ret;
+	}
+
+	// corpus: one "<scanned> <confirmed>" pair per line, '?' for illegible digits
+	int train(std::istream& in, double marginBits) {
+		std::vector<Correction> corpus;
+		std::string line;
+		while (std::getline(in, line)) {
+			std::istringstream fields(line);
+			std::string read, confirmed;
+			if (!(fields >> read >> confirmed)) continue;
+			corpus.push_back({ parseDigits(read), parseDigits(confirmed) });
+		}
+		std::cout << trainConfusionModel(corpus, marginBits).toString();
+		return 0;
+	}
+
+	// accounts: one 9 digit account per line
+	int known(std::istream& in, const std::string& out, bool compressed) {
+		std::vector<uint32_t> accounts;
+		std::string line;
+		while (std::getline(in, line)) {
+			if (line.empty()) continue;
+			accounts.push_back(uint32_t(std::stoul(line)));
+		}
+		writeKnownAccounts(out, accounts, compressed);
+		return 0;
+	}
+
+	// prints the result of every digit band of a scan
+	int image(const std::string& path, int threshold) {
+		RasterOptions options;
+		options.threshold = threshold;
+		for (auto& digits : readBands(loadBitmap(path), OCR::getGlyphSet(), options)) {
+			std::cout << getCheckPlus(digits) << "\n";
+		}
+		return 0;
+	}
+
+	// text results => binary result columns
+	int pack(std::istream& in, const std::string& out) {
+		readResultText(in).write(out);
+		return 0;
+	}
+
+	int unpack(const std::string& path) {
+		writeResultText(ResultColumns(path), std::cout);
+		return 0;
+	}
+
+	// decodes entries first .. first + count - 1 of an indexed archive
+	int entry(const std::string& archive, const std::string& index, size_t first, size_t count) {
+		for (auto& digits : ScanArchive(archive, index).read(first, count)) std::cout << getCheckPlus(digits) << "\n";
+		return 0;
+	}
+
+	bool writeText(const std::string& path, const std::string& text) {
+		std::ofstream out(path);
+		if (out << text) return true;
+		std::cerr << "cannot write " << path << "\n";
+		return false;
+	}
+
+	int usage() {
+		std::cerr << "usage: ocrtool train [corpus] [margin bits]\n"
+			"       ocrtool known <accounts> <out> [--compressed]\n"
+			"       ocrtool image <scan.pbm|scan.pgm> [threshold]\n"
+			"       ocrtool pack <results> <out>\n"
+			"       ocrtool unpack <columns>\n"
+			"       ocrtool index <archive> <out> [interval]\n"
+			"       ocrtool entry <archive> <index> <n> [count]\n"
+			"       ocrtool batch <archive> <out> [--journal <file>] [--checkpoint <MB>] [--cache <file>]\n"
+			"                     [--stats <file>] [--latency <file>] [--metrics <file>] [--metrics-socket <path>]\n"
+			"                     [--trace <file>]\n"
+			"       ocrtool difftest [--entries <n>] [--seconds <s>] [--seed <n>]\n";
+		return 2;
+	}
+
+	// options after the archive and output: --journal <file>, --checkpoint <MB>, --cache <file>,
+	// --stats <file> for the error summary, --latency <file> for the stage percentiles,
+	// --metrics <file> rewritten every 5 s, --metrics-socket <path> served while running,
+	// --trace <file> for Chrome trace-event JSON written at the end, also of a failed run, and on SIGUSR1
+	int batch(int argc, char** argv) {
+		if ((argc - 4) % 2) return usage();
+		BatchOptions options;
+		std::string statsPath, latencyPath, metricsPath, socketPath, tracePath;
+		StageLatency latency;
+		Metrics metrics;
+		for (int i = 4; i + 1 < argc; i += 2) {
+			std::string name = argv[i];
+			if (name == "--journal") options.journal = argv[i + 1];
+			else if (name == "--checkpoint") options.checkpointBytes = std::stoull(argv[i + 1]) << 20;
+			else if (name == "--cache") options.cache = argv[i + 1];
+			else if (name == "--stats") statsPath = argv[i + 1];
+			else if (name == "--metrics") metricsPath = argv[i + 1];
+			else if (name == "--metrics-socket") socketPath = argv[i + 1];
+			else if (name == "--trace") tracePath = argv[i + 1];
+			else if (name == "--latency") {
+				latencyPath = argv[i + 1];
+				options.latency = &latency;
+			}
+			else return usage();
+		}
+		if (!metricsPath.empty() || !socketPath.empty()) options.metrics = &metrics;
+		std::unique_ptr<MetricsFileWriter> file;
+		std::unique_ptr<MetricsServer> server;
+		if (!metricsPath.empty()) file.reset(new MetricsFileWriter(metricsPath, metrics, std::chrono::seconds(5)));
+		if (!socketPath.empty()) server.reset(new MetricsServer(socketPath, metrics));
+		std::unique_ptr<Tracer> tracer;
+		std::unique_ptr<TraceDumper> dumper;
+		if (!tracePath.empty()) {
+			tracer.reset(new Tracer());
+			tracer->setThreadName("batch");
+			dumper.reset(new TraceDumper(tracePath, *tracer));
+			options.trace = tracer.get();
+		}
+		auto writeTrace = [&] {
+			dumper.reset();
+			if (tracer) tracer->write(tracePath);
+		};
+		BatchStats stats;
+		try {
+			stats = runBatch(argv[2], argv[3], options);
+		}
+		catch (...) {
+			// the trace of a failed run is the one worth reading
+			writeTrace();
+			throw;
+		}
+		writeTrace();
+		std::cerr << stats.entries << " entries decoded, " << stats.resumed << " resumed, " << stats.reused << " cached, "
+			<< stats.checkpoints << " checkpoints\n";
+		if (!statsPath.empty() && !writeText(statsPath, stats.errors.toString())) return 1;
+		if (!latencyPath.empty() && !writeText(latencyPath, latency.toString())) return 1;
+		return 0;
+	}
+
+	// the soak mode of the differential test: 10 million entries unless limited otherwise,
+	// 0 entries for no limit
+	int difftest(int argc, char** argv) {
+		if (argc % 2) return usage();
+		DifferentialOptions options;
+		options.entries = 10000000;
+		for (int i = 2; i + 1 < argc; i += 2) {
+			std::string name = argv[i];
+			if (name == "--entries") options.entries = std::stoull(argv[i + 1]);
+			else if (name == "--seconds") options.seconds = std::stod(argv[i + 1]);
+			else if (name == "--seed") options.seed = std::stoull(argv[i + 1]);
+			else return usage();
+		}
+		auto report = runDifferential(options);
+		std::cout << report.toString();
+		return report.failed ? 1 : 0;
+	}
+}
+
+int run(int argc, char** argv) {
+	if (argc < 2) return usage();
+	std::string cmd = argv[1];
+	if (cmd == "train") {
+		double margin = argc > 3 ? std::stod(argv[3]) : 4.0;
+		if (argc < 3) return train(std::cin, margin);
+		std::ifstream in(argv[2]);
+		if (!in) {
+			std::cerr << "cannot open " << argv[2] << "\n";
+			return 1;
+		}
+		return train(in, margin);
+	}
+	if (cmd == "known" && argc > 3) {
+		std::ifstream in(argv[2]);
+		if (!in) {
+			std::cerr << "cannot open " << argv[2] << "\n";
+			return 1;
+		}
+		return known(in, argv[3], argc > 4 && std::string(argv[4]) == "--compressed");
+	}
+	if (cmd == "image" && argc > 2) {
+		return image(argv[2], argc > 3 ? std::stoi(argv[3]) : 128);
+	}
+	if (cmd == "pack" && argc > 3) {
+		std::ifstream in(argv[2]);
+		if (!in) {
+			std::cerr << "cannot open " << argv[2] << "\n";
+			return 1;
+		}
+		return pack(in, argv[3]);
+	}
+	if (cmd == "unpack" && argc > 2) {
+		return unpack(argv[2]);
+	}
+	if (cmd == "index" && argc > 3) {
+		writeEntryIndex(argv[2], argv[3], argc > 4 ? uint32_t(std::stoul(argv[4])) : 64);
+		return 0;
+	}
+	if (cmd == "batch" && argc > 3) {
+		return batch(argc, argv);
+	}
+	if (cmd == "difftest") {
+		return difftest(argc, argv);
+	}
+	if (cmd == "entry" && argc > 4) {
+		return entry(argv[2], argv[3], std::stoul(argv[4]), argc > 5 ? std::stoul(argv[5]) : 1);
+	}
+	return usage();
+}
+
+int main(int argc, char** argv) {
+	try {
+		return run(argc, argv);
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << "\n";
+		return 1;
+	}
+}